@@ -45,6 +45,35 @@ void test_ms_compare() {
     }
 }
 
+void test_ms_copy_bounded() {
+    char s1[8];
+    char *end = s1 + sizeof s1;
+
+    char *a = ms_copy_bounded(s1, "key", end - s1);
+    a = ms_copy_bounded(a, "=", end - a);
+    a = ms_copy_bounded(a, "value", end - a);
+
+    if (a != end || strcmp(s1, "key=val")) {
+        printf("ms_copy_bounded error: %s\n", s1);
+    }
+}
+
+void test_ms_ncopy_large() {
+    char s1[] = "this";
+    char s2[300];
+    char s3[300];
+
+    memset(s2, 'x', sizeof s2);
+    memset(s3, 'x', sizeof s3);
+
+    ms_ncopy(s2 + 1, s1, 200);
+    strncpy(s3 + 1, s1, 200); /* string.h */
+
+    if (memcmp(s2, s3, sizeof s2)) {
+        printf("ms_ncopy error: large padding\n");
+    }
+}
+
 void test_ms_concat() {
     char s1[] = "this";
     char s2[9] = "that";
@@ -108,6 +137,255 @@ void test_ms_nconcat() {
     }
 }
 
+void test_ms_find_all() {
+    char s1[] = "abcabcab";
+    char s2[] = "ab";
+    size_t offsets[2];
+
+    size_t count = ms_find_all(s1, s2, offsets, 2);
+
+    if (count != 3 || offsets[0] != 0 || offsets[1] != 3) {
+        printf("ms_find_all error: %lu\n", (unsigned long) count);
+    }
+}
+
+void add_offset(size_t offset, void *arg) {
+    *(size_t *) arg += offset;
+}
+
+void test_ms_find_each() {
+    char s1[] = "aaaaa";
+    char s2[] = "aa";
+    size_t sum = 0;
+
+    size_t count = ms_find_each(s1, s2, add_offset, &sum);
+
+    if (count != 2 || sum != 2) {
+        printf("ms_find_each error: %lu %lu\n", (unsigned long) count,
+                                               (unsigned long) sum);
+    }
+}
+
+void test_ms_replace_all() {
+    char s1[] = "Hello {name}, {name}!";
+    char s2[] = "{name}";
+    char s3[] = "there";
+
+    char *a = ms_replace_all(s1, s2, s3);
+
+    if (!a || strcmp(a, "Hello there, there!")) {
+        printf("ms_replace_all error: %s\n", a);
+    }
+    free(a);
+}
+
+void test_ms_replace_multi() {
+    char s1[] = "<a & b>";
+    const char *from[] = {"<", ">", "&"};
+    const char *to[] = {"&lt;", "&gt;", "&amp;"};
+
+    char *a = ms_replace_multi(s1, from, to, 3);
+
+    if (!a || strcmp(a, "&lt;a &amp; b&gt;")) {
+        printf("ms_replace_multi error: %s\n", a);
+    }
+    free(a);
+}
+
+void test_ms_glob_match() {
+    const char *patterns[] = {"/api/v?/[a-z]*", "*.txt"};
+    ms_glob *glob = ms_glob_compile(patterns, 2);
+
+    int a = ms_glob_match(glob, "/api/v2/users");
+    int b = ms_glob_match(glob, "/api/v2/Users.txt");
+    int c = ms_glob_match(glob, "/api/v10/users");
+
+    if (a != 0 || b != 1 || c != -1) {
+        printf("ms_glob_match error: %d %d %d\n", a, b, c);
+    }
+    ms_glob_free(glob);
+}
+
+void test_ms_find_char() {
+    char s1[] = "key=value";
+
+    char *a = ms_find_char(s1, '=');
+    char *b = strchr(s1, '='); /* string.h */
+
+    if (a != b) {
+        printf("ms_find_char error: %s %s\n", a, b);
+    }
+}
+
+void test_ms_rfind_char() {
+    char s1[] = "/usr/local/bin";
+
+    char *a = ms_rfind_char(s1, '/');
+    char *b = strrchr(s1, '/'); /* string.h */
+
+    if (a != b) {
+        printf("ms_rfind_char error: %s %s\n", a, b);
+    }
+}
+
+void test_ms_find_any() {
+    char s1[] = "name,\"quoted\"\r\n";
+    char s2[] = ",\"\r\n";
+
+    char *a = ms_find_any(s1, s2);
+    char *b = strpbrk(s1, s2); /* string.h */
+
+    if (a != b) {
+        printf("ms_find_any error: %s %s\n", a, b);
+    }
+}
+
+void test_ms_span() {
+    char s1[] = " \t value";
+    char s2[] = " \t";
+
+    size_t a = ms_span(s1, s2);
+    size_t b = strspn(s1, s2); /* string.h */
+
+    if (a != b) {
+        printf("ms_span error: %lu %lu\n", (unsigned long) a,
+                                          (unsigned long) b);
+    }
+}
+
+void test_ms_cspan() {
+    char s1[] = "GET /index.html HTTP/1.1";
+    char s2[] = " \r\n";
+
+    size_t a = ms_cspan(s1, s2);
+    size_t b = strcspn(s1, s2); /* string.h */
+
+    if (a != b) {
+        printf("ms_cspan error: %lu %lu\n", (unsigned long) a,
+                                           (unsigned long) b);
+    }
+}
+
+void test_ms_byteset() {
+    char s1[] = "a=1;b=2";
+    ms_byteset byteset;
+
+    ms_byteset_init(&byteset, "=;");
+
+    if (ms_find_any_byteset(s1, &byteset) != strpbrk(s1, "=;") ||
+        ms_span_byteset(s1, &byteset) != strspn(s1, "=;") ||
+        ms_cspan_byteset(s1, &byteset) != strcspn(s1, "=;")) {
+        printf("ms_byteset error\n");
+    }
+}
+
+void test_ms_fuzzy_search() {
+    char s1[] = "red wireless keybaord and mouse";
+    char s2[] = "keyboard";
+    size_t length;
+
+    char *a = ms_fuzzy_search(s1, s2, 2, &length);
+    char *b = strstr(s1, "keybaord"); /* string.h */
+
+    if (a != b || length != 8) {
+        printf("ms_fuzzy_search error: %s %s\n", a, b);
+    }
+}
+
+void test_ms_edit_distance() {
+    char s1[] = "kitten";
+    char s2[] = "sitting";
+
+    size_t a = ms_edit_distance(s1, s2, 5);
+    size_t b = ms_edit_distance(s1, s2, 2);
+    size_t c = ms_edit_distance(s1, s2, (size_t) -1);
+
+    if (a != 3 || b != 3 || c != 3) {
+        printf("ms_edit_distance error: %lu %lu %lu\n", (unsigned long) a,
+               (unsigned long) b, (unsigned long) c);
+    }
+}
+
+void test_ms_strtab() {
+    const char *keys[] = {"apple", "applesauce", "apply", "banana", "band"};
+    ms_strtab_builder *builder = ms_strtab_builder_new(2);
+    FILE *file = tmpfile();
+    char data[256];
+    char s1[16];
+    size_t size, i, index = 0;
+    ms_strtab *tab;
+
+    for (i = 0; i < 5; i++) {
+        ms_strtab_builder_add(builder, keys[i]);
+    }
+    ms_strtab_builder_write(builder, file);
+    ms_strtab_builder_free(builder);
+    rewind(file);
+    size = fread(data, 1, sizeof data, file);
+    fclose(file);
+
+    tab = ms_strtab_open(data, size);
+    if (!tab || !ms_strtab_find(tab, "apply", &index) || index != 2 ||
+        ms_strtab_find(tab, "bananas", NULL) ||
+        strcmp(ms_strtab_get(tab, 1, s1), "applesauce")) {
+        printf("ms_strtab error\n");
+    }
+    if (tab) {
+        ms_strtab_close(tab);
+    }
+}
+
+void test_ms_count_char() {
+    char s1[] = "one\ntwo\nthree\n";
+
+    size_t a = ms_count_char(s1, '\n');
+
+    if (a != 3) {
+        printf("ms_count_char error: %lu\n", (unsigned long) a);
+    }
+}
+
+void test_ms_line_index() {
+    char s1[] = "first\nsecond match\n\nfourth match";
+    size_t num_lines, a, b;
+
+    size_t *lines = ms_line_index(s1, &num_lines);
+    char *match = ms_search(s1, "match");
+
+    a = ms_line_number(lines, num_lines, s1, match);
+    b = ms_line_number(lines, num_lines, s1, ms_search(match + 1, "match"));
+
+    if (num_lines != 4 || lines[3] != 20 || a != 2 || b != 4) {
+        printf("ms_line_index error: %lu %lu %lu\n",
+               (unsigned long) num_lines, (unsigned long) a,
+               (unsigned long) b);
+    }
+    free(lines);
+}
+
+void test_ms_glob_compile_limit() {
+    const char *patterns[] = {"*a????????????????????"};
+
+    /* needs about 2^21 states */
+    ms_glob *glob = ms_glob_compile(patterns, 1);
+
+    if (glob) {
+        printf("ms_glob_compile error: state limit not enforced\n");
+        ms_glob_free(glob);
+    }
+}
+
+void test_ms_glob_compile_invalid() {
+    const char *patterns[] = {"[abc", "abc\\"};
+
+    ms_glob *a = ms_glob_compile(patterns, 1);
+    ms_glob *b = ms_glob_compile(patterns + 1, 1);
+
+    if (a || b) {
+        printf("ms_glob_compile error: invalid pattern accepted\n");
+    }
+}
+
 int main() {
     test_ms_copy();
     test_ms_length();
@@ -117,6 +395,26 @@ int main() {
     test_ms_ncopy();
     test_ms_ncompare();
     test_ms_nconcat();
+    test_ms_copy_bounded();
+    test_ms_ncopy_large();
+    test_ms_find_all();
+    test_ms_find_each();
+    test_ms_replace_all();
+    test_ms_replace_multi();
+    test_ms_glob_match();
+    test_ms_glob_compile_limit();
+    test_ms_glob_compile_invalid();
+    test_ms_find_char();
+    test_ms_rfind_char();
+    test_ms_find_any();
+    test_ms_span();
+    test_ms_cspan();
+    test_ms_byteset();
+    test_ms_fuzzy_search();
+    test_ms_edit_distance();
+    test_ms_strtab();
+    test_ms_count_char();
+    test_ms_line_index();
 
     return 0;
 }
\ No newline at end of file
@@ -48,6 +48,25 @@ Returns: pointer to destination array dest */
 char *ms_ncopy(char *dest, const char *src, size_t num);
 
 
+/* Copies at most size - 1 characters from the character array src to the
+character array dest and ends dest with a null character, unless size is 0.
+The returned pointer can be used as dest of the next call, with size
+reduced accordingly, in order to append to dest without searching for its
+end.
+
+Checks: whether both arrays are NULL at runtime.
+
+Parameters:
+src: source character array to copy from. Must end with null char if its
+length < size.
+dest: destination character array to copy to.
+size: size of dest.
+
+Returns: pointer to the terminating null character of dest, or dest + size
+if src does not fit in dest or size is 0 */
+char *ms_copy_bounded(char *dest, const char *src, size_t size);
+
+
 /* Appends the character array src to the character array dest.
 It overwrites the terminating null character of src and adds a terminating
 null character at the end of dest. Size of dest must be large enough to hold
@@ -125,4 +144,491 @@ haystack: character array. Must end with null char.
 needle: character array. Must end with null char.
 
 Returns: if needle is found a pointer to it, else NULL */
-char *ms_search(const char *haystack, const char *needle);
\ No newline at end of file
+char *ms_search(const char *haystack, const char *needle);
+
+
+/* Finds all non-overlapping occurences of the character array needle in the
+character array haystack, scanning from left to right. The offsets of the
+occurences from the beginning of haystack are stored in offsets, up to
+max_offsets of them. An empty needle has no occurences.
+
+Checks: whether both arrays are NULL at runtime.
+
+Parameters:
+haystack: character array. Must end with null char.
+needle: character array. Must end with null char.
+offsets: array that receives the offsets. Can be NULL if max_offsets is 0.
+max_offsets: maximum number of offsets stored in offsets.
+
+Returns: the number of occurences, which can be larger than max_offsets */
+size_t ms_find_all(const char *haystack, const char *needle,
+                   size_t *offsets, size_t max_offsets);
+
+
+/* Finds all non-overlapping occurences of the character array needle in the
+character array haystack, scanning from left to right, and calls callback
+for each one of them with its offset from the beginning of haystack.
+An empty needle has no occurences.
+
+Checks: whether haystack, needle and callback are NULL at runtime.
+
+Parameters:
+haystack: character array. Must end with null char.
+needle: character array. Must end with null char.
+callback: function called for each occurence.
+arg: pointer passed unchanged to callback.
+
+Returns: the number of occurences */
+size_t ms_find_each(const char *haystack, const char *needle,
+                    void (*callback)(size_t offset, void *arg), void *arg);
+
+
+/* Replaces all non-overlapping occurences of the character array from in the
+character array str with the character array to. The result is written to
+a new array that has exactly the size required. An empty from has no
+occurences. The returned array must be deallocated with free.
+
+Checks: whether str, from and to are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+from: character array to replace. Must end with null char.
+to: replacement character array. Must end with null char.
+
+Returns: pointer to the new array, or NULL if memory allocation fails */
+char *ms_replace_all(const char *str, const char *from, const char *to);
+
+
+/* Replaces the occurences of each of the num character arrays from[i] in the
+character array str with the character array to[i], in a single scan of str.
+At each position of str the pairs are tried in order and the first one that
+matches is replaced, then the scan continues after the replaced characters.
+Empty from arrays have no occurences. The result is written to a new array
+that has exactly the size required. The returned array must be deallocated
+with free.
+
+Checks: whether str, from and to are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+from: num character arrays to replace. Each must end with null char.
+to: num replacement character arrays. Each must end with null char.
+num: number of pairs.
+
+Returns: pointer to the new array, or NULL if memory allocation fails */
+char *ms_replace_multi(const char *str, const char *const *from,
+                       const char *const *to, size_t num);
+
+
+/* Maximum number of states of the automaton built by ms_glob_compile. Some
+sets of patterns, such as *a followed by many '?', need a number of states
+that grows exponentially with their length. Must not be larger than
+UINT_MAX. Can be defined when compiling the library. */
+#ifndef MS_GLOB_MAX_STATES
+#define MS_GLOB_MAX_STATES 65536
+#endif
+
+
+/* Set of wildcard patterns compiled to a deterministic finite automaton.
+It is not modified by ms_glob_match, so it can be shared between threads. */
+typedef struct ms_glob ms_glob;
+
+
+/* Compiles the num wildcard patterns to a deterministic finite automaton
+that can be used by ms_glob_match. In a pattern, '*' matches any sequence
+of characters, '?' matches any character, and [set] matches any character
+in set. A set can contain ranges such as a-z, it is negated when it begins
+with '!' or '^', and a ']' is a member of the set if it is the first
+character of the set. A '\' followed by a character matches that character,
+also inside a set. Every other character matches itself. The result must be
+deallocated with ms_glob_free.
+
+Checks: whether patterns is NULL at runtime.
+
+Parameters:
+patterns: num character arrays. Each must end with null char.
+num: number of patterns.
+
+Returns: pointer to the compiled patterns, or NULL if a pattern has a
+set that is not terminated by ']' or ends with a single '\', the automaton
+needs more than MS_GLOB_MAX_STATES states, or memory allocation fails */
+ms_glob *ms_glob_compile(const char *const *patterns, size_t num);
+
+
+/* Matches the character array str against the compiled patterns glob in
+time proportional to the length of str. The whole str must match.
+
+Checks: whether glob and str are NULL at runtime.
+
+Parameters:
+glob: compiled patterns returned by ms_glob_compile.
+str: character array. Must end with null char.
+
+Returns: the index of the first pattern that matches str, or -1 if no
+pattern matches str */
+int ms_glob_match(const ms_glob *glob, const char *str);
+
+
+/* Deallocates the compiled patterns glob.
+
+Checks: whether glob is NULL at runtime.
+
+Parameters:
+glob: compiled patterns returned by ms_glob_compile. */
+void ms_glob_free(ms_glob *glob);
+
+
+/* Set of characters that can be built once with ms_byteset_init and reused
+by ms_find_any_byteset, ms_span_byteset and ms_cspan_byteset. A lookup
+table classifies each character with a single load, so the cost of a scan
+does not depend on the size of the set. The members are private. */
+typedef struct ms_byteset {
+    unsigned char members[256];
+} ms_byteset;
+
+
+/* Finds the first occurence of the character c (converted to char) in the
+character array str. The terminating null character is considered part of
+str, so it is found if c is 0.
+
+Checks: whether array is NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+c: character to find.
+
+Returns: if c is found a pointer to it, else NULL */
+char *ms_find_char(const char *str, int c);
+
+
+/* Finds the last occurence of the character c (converted to char) in the
+character array str. The terminating null character is considered part of
+str, so it is found if c is 0.
+
+Checks: whether array is NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+c: character to find.
+
+Returns: if c is found a pointer to it, else NULL */
+char *ms_rfind_char(const char *str, int c);
+
+
+/* Builds the set of the characters in the character array set.
+
+Checks: whether byteset and set are NULL at runtime.
+
+Parameters:
+byteset: set to build.
+set: character array. Must end with null char. */
+void ms_byteset_init(ms_byteset *byteset, const char *set);
+
+
+/* Finds the first character of the character array str that is in the
+character array set. The terminating null characters are not compared.
+
+Checks: whether both arrays are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+set: character array. Must end with null char.
+
+Returns: if a character is found a pointer to it, else NULL */
+char *ms_find_any(const char *str, const char *set);
+
+
+/* Finds the first character of the character array str that is in the set
+byteset. The terminating null character is not compared.
+
+Checks: whether str and byteset are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+byteset: set built by ms_byteset_init.
+
+Returns: if a character is found a pointer to it, else NULL */
+char *ms_find_any_byteset(const char *str, const ms_byteset *byteset);
+
+
+/* Calculates the length of the initial part of the character array str
+that consists only of characters in the character array set.
+
+Checks: whether both arrays are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+set: character array. Must end with null char.
+
+Returns: length of the initial part of str */
+size_t ms_span(const char *str, const char *set);
+
+
+/* Calculates the length of the initial part of the character array str
+that consists only of characters in the set byteset.
+
+Checks: whether str and byteset are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+byteset: set built by ms_byteset_init.
+
+Returns: length of the initial part of str */
+size_t ms_span_byteset(const char *str, const ms_byteset *byteset);
+
+
+/* Calculates the length of the initial part of the character array str
+that consists only of characters not in the character array set.
+
+Checks: whether both arrays are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+set: character array. Must end with null char.
+
+Returns: length of the initial part of str */
+size_t ms_cspan(const char *str, const char *set);
+
+
+/* Calculates the length of the initial part of the character array str
+that consists only of characters not in the set byteset.
+
+Checks: whether str and byteset are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+byteset: set built by ms_byteset_init.
+
+Returns: length of the initial part of str */
+size_t ms_cspan_byteset(const char *str, const ms_byteset *byteset);
+
+
+/* Finds the first approximate occurence of the character array needle in
+the character array haystack, that is a part of haystack whose edit
+distance from needle is at most k. The edit distance is the minimum number
+of characters that must be inserted, deleted or substituted. The occurence
+that ends first is extended while its distance decreases, and among the
+parts of haystack that end there the one with the lowest distance is
+returned. Runs in time proportional to the length of haystack times the
+number of machine words needed for the bits of needle.
+
+Checks: whether haystack and needle are NULL at runtime.
+
+Parameters:
+haystack: character array. Must end with null char.
+needle: character array. Must end with null char.
+k: maximum edit distance.
+match_length: receives the length of the occurence. Can be NULL.
+
+Returns: if an occurence is found a pointer to it, else NULL. Also returns
+NULL if memory allocation fails */
+char *ms_fuzzy_search(const char *haystack, const char *needle, size_t k,
+                      size_t *match_length);
+
+
+/* Calculates the edit distance of the character arrays str1 and str2, that
+is the minimum number of characters that must be inserted, deleted or
+substituted in order to change str1 to str2. Stops early once the distance
+is known to be larger than max_distance.
+
+Checks: whether both arrays are NULL at runtime.
+
+Parameters:
+str1: character array. Must end with null char.
+str2: character array. Must end with null char.
+max_distance: maximum edit distance of interest. Values larger than
+(size_t) -3 are treated as (size_t) -3, so that the results below differ.
+
+Returns: the edit distance if it is at most max_distance, else
+max_distance + 1. Returns (size_t) -1 if memory allocation fails */
+size_t ms_edit_distance(const char *str1, const char *str2,
+                        size_t max_distance);
+
+
+/* Immutable table of sorted character arrays. The arrays are stored in
+blocks, and each array of a block is stored as the number of characters it
+shares with the previous array followed by the rest of its characters.
+An index with the offset of each block allows binary search. Tables are
+created with ms_strtab_builder_new, ms_strtab_builder_add and
+ms_strtab_builder_write, and used in place with ms_strtab_open, so a table
+can be read from a file mapped to memory without parsing or copying it.
+A table is not modified after ms_strtab_open, so it can be shared between
+threads. */
+typedef struct ms_strtab ms_strtab;
+
+
+/* Builder of a table of sorted character arrays, see ms_strtab */
+typedef struct ms_strtab_builder ms_strtab_builder;
+
+
+/* Creates a builder of a table with block_size character arrays in each
+block. Larger blocks need less memory for the index, but lookups decode
+more arrays. The result must be deallocated with ms_strtab_builder_free.
+
+Checks: whether block_size is 0 at runtime.
+
+Parameters:
+block_size: number of character arrays in each block.
+
+Returns: pointer to the builder, or NULL if memory allocation fails */
+ms_strtab_builder *ms_strtab_builder_new(size_t block_size);
+
+
+/* Adds the character array str to the table. Arrays must be added in
+strictly ascending order according to ms_compare.
+
+Checks: whether builder and str are NULL at runtime.
+
+Parameters:
+builder: builder returned by ms_strtab_builder_new.
+str: character array. Must end with null char.
+
+Returns: 0 on success, or -1 if str is not greater than the previous
+array, the table exceeds 4 GiB, or memory allocation fails */
+int ms_strtab_builder_add(ms_strtab_builder *builder, const char *str);
+
+
+/* Writes the table to file.
+
+Checks: whether builder and file are NULL at runtime.
+
+Parameters:
+builder: builder returned by ms_strtab_builder_new.
+file: file opened for writing in binary mode.
+
+Returns: 0 on success, or -1 if writing fails */
+int ms_strtab_builder_write(const ms_strtab_builder *builder, FILE *file);
+
+
+/* Deallocates the builder.
+
+Checks: whether builder is NULL at runtime.
+
+Parameters:
+builder: builder returned by ms_strtab_builder_new. */
+void ms_strtab_builder_free(ms_strtab_builder *builder);
+
+
+/* Opens the table that has been written by ms_strtab_builder_write and
+occupies the size bytes at data. Only the header of the table is checked,
+and data is used in place, so it must remain valid and unchanged until
+ms_strtab_close. It can be a read-only memory mapping of the file.
+The result must be deallocated with ms_strtab_close.
+
+Checks: whether data is NULL at runtime.
+
+Parameters:
+data: contents of the table.
+size: number of bytes of data.
+
+Returns: pointer to the table, or NULL if data is not a table or memory
+allocation fails */
+ms_strtab *ms_strtab_open(const void *data, size_t size);
+
+
+/* Returns the number of character arrays in the table tab.
+
+Checks: whether tab is NULL at runtime.
+
+Parameters:
+tab: table returned by ms_strtab_open.
+
+Returns: number of character arrays */
+size_t ms_strtab_count(const ms_strtab *tab);
+
+
+/* Returns the length of the longest character array in the table tab.
+
+Checks: whether tab is NULL at runtime.
+
+Parameters:
+tab: table returned by ms_strtab_open.
+
+Returns: length of the longest character array */
+size_t ms_strtab_max_length(const ms_strtab *tab);
+
+
+/* Finds the character array key in the table tab with a binary search of
+the blocks followed by a scan of one block.
+
+Checks: whether tab and key are NULL at runtime.
+
+Parameters:
+tab: table returned by ms_strtab_open.
+key: character array. Must end with null char.
+index: receives the position of key in the table. Can be NULL.
+
+Returns: 1 if key is found, else 0 */
+int ms_strtab_find(const ms_strtab *tab, const char *key, size_t *index);
+
+
+/* Copies the character array at position index of the table tab to the
+character array dest. Size of dest must be larger than
+ms_strtab_max_length(tab) or else the behavior is undefined.
+
+Checks: whether tab and dest are NULL at runtime.
+
+Parameters:
+tab: table returned by ms_strtab_open.
+index: position of the character array in the table.
+dest: destination character array to copy to.
+
+Returns: pointer to destination array dest, or NULL if index is not less
+than ms_strtab_count(tab) */
+char *ms_strtab_get(const ms_strtab *tab, size_t index, char *dest);
+
+
+/* Deallocates the table tab. The data passed to ms_strtab_open are not
+deallocated.
+
+Checks: whether tab is NULL at runtime.
+
+Parameters:
+tab: table returned by ms_strtab_open. */
+void ms_strtab_close(ms_strtab *tab);
+
+
+/* Counts the occurences of the character c (converted to char) in the
+character array str. The terminating null character is not counted.
+
+Checks: whether array is NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+c: character to count.
+
+Returns: number of occurences of c */
+size_t ms_count_char(const char *str, int c);
+
+
+/* Builds the index of the lines of the character array str, that is the
+offsets of the beginnings of its lines from the beginning of str. A line
+begins at the beginning of str and after each newline character, so the
+number of lines is the number of newline characters plus 1. The returned
+array has exactly that size and must be deallocated with free.
+
+Checks: whether str and num_lines are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+num_lines: receives the number of lines.
+
+Returns: pointer to the array of offsets, or NULL if memory allocation
+fails */
+size_t *ms_line_index(const char *str, size_t *num_lines);
+
+
+/* Finds the line of the character array str that contains the character
+at pos, with a binary search of the index of its lines.
+
+Checks: whether lines, str and pos are NULL at runtime.
+
+Parameters:
+lines: index of the lines of str returned by ms_line_index.
+num_lines: number of lines of str.
+str: character array. Must end with null char.
+pos: pointer to a character of str.
+
+Returns: number of the line, starting from 1 */
+size_t ms_line_number(const size_t *lines, size_t num_lines,
+                      const char *str, const char *pos);
\ No newline at end of file
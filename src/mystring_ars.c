@@ -3,6 +3,8 @@
 Array based implementation */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
 #include "mystring.h"
 #include <assert.h>
 
@@ -101,6 +103,51 @@ char *ms_ncopy(char dest[], char const src[], size_t num) {
 }
 
 
+/* Copies at most size - 1 characters from the character array src to the
+character array dest and ends dest with a null character, unless size is 0.
+The returned pointer can be used as dest of the next call, with size
+reduced accordingly, in order to append to dest without searching for its
+end.
+
+Checks: whether both arrays are NULL at runtime.
+
+Parameters:
+src: source character array to copy from. Must end with null char if its
+length < size.
+dest: destination character array to copy to.
+size: size of dest.
+
+Returns: pointer to the terminating null character of dest, or dest + size
+if src does not fit in dest or size is 0 */
+char *ms_copy_bounded(char dest[], char const src[], size_t size) {
+    size_t i;
+
+    assert(dest);
+    assert(src);
+
+    /* copy all characters except null and at most size - 1 characters */
+    i = 0U;
+    while (src[i] && i + 1 < size) {
+        dest[i] = src[i];
+        i++;
+    }
+
+    if (!size) {
+        return dest;
+    }
+
+    /* append terminating null character */
+    dest[i] = '\0';
+
+    /* src does not fit in dest if it has more characters */
+    if (src[i]) {
+        return &dest[size];
+    }
+
+    return &dest[i];
+}
+
+
 /* Appends the character array src to the character array dest.
 It overwrites the terminating null character of src and adds a terminating
 null character at the end of dest. Size of dest must be large enough to hold
@@ -282,4 +329,1904 @@ char *ms_search(char const haystack[], char const needle[]) {
     }
     
     return NULL;
+}
+
+
+/* Returns the position of the first occurence of needle (of length
+needle_length > 0) in haystack (of length haystack_length) at or after
+position start, or haystack_length if there is none. */
+static size_t ms_next_match(char const haystack[], size_t haystack_length,
+                            size_t start, char const needle[],
+                            size_t needle_length) {
+    size_t i, j;
+
+    /* for positions start to (haystack_length - needle_length) */
+    for (i = start; i + needle_length <= haystack_length; i++) {
+
+        /* search for needle */
+        for (j = 0U; j < needle_length; j++) {
+            if (haystack[j+i] != needle[j]) {
+                break;
+            }
+        }
+
+        /* needle found if needle_length characters have been searched */
+        if (j == needle_length) {
+            return i;
+        }
+    }
+
+    return haystack_length;
+}
+
+
+/* Finds all non-overlapping occurences of the character array needle in the
+character array haystack, scanning from left to right. The offsets of the
+occurences from the beginning of haystack are stored in offsets, up to
+max_offsets of them. An empty needle has no occurences.
+
+Checks: whether both arrays are NULL at runtime.
+
+Parameters:
+haystack: character array. Must end with null char.
+needle: character array. Must end with null char.
+offsets: array that receives the offsets. Can be NULL if max_offsets is 0.
+max_offsets: maximum number of offsets stored in offsets.
+
+Returns: the number of occurences, which can be larger than max_offsets */
+size_t ms_find_all(char const haystack[], char const needle[],
+                   size_t offsets[], size_t max_offsets) {
+    size_t i, count, haystack_length, needle_length;
+
+    assert(haystack);
+    assert(needle);
+
+    haystack_length = ms_length(haystack);
+    needle_length = ms_length(needle);
+    if (!needle_length) {
+        return 0U;
+    }
+
+    /* continue each search right after the previous occurence */
+    count = 0U;
+    i = ms_next_match(haystack, haystack_length, 0U, needle, needle_length);
+    while (i != haystack_length) {
+        if (count < max_offsets) {
+            offsets[count] = i;
+        }
+        count++;
+        i = ms_next_match(haystack, haystack_length, i + needle_length,
+                          needle, needle_length);
+    }
+
+    return count;
+}
+
+
+/* Finds all non-overlapping occurences of the character array needle in the
+character array haystack, scanning from left to right, and calls callback
+for each one of them with its offset from the beginning of haystack.
+An empty needle has no occurences.
+
+Checks: whether haystack, needle and callback are NULL at runtime.
+
+Parameters:
+haystack: character array. Must end with null char.
+needle: character array. Must end with null char.
+callback: function called for each occurence.
+arg: pointer passed unchanged to callback.
+
+Returns: the number of occurences */
+size_t ms_find_each(char const haystack[], char const needle[],
+                    void (*callback)(size_t offset, void *arg), void *arg) {
+    size_t i, count, haystack_length, needle_length;
+
+    assert(haystack);
+    assert(needle);
+    assert(callback);
+
+    haystack_length = ms_length(haystack);
+    needle_length = ms_length(needle);
+    if (!needle_length) {
+        return 0U;
+    }
+
+    /* continue each search right after the previous occurence */
+    count = 0U;
+    i = ms_next_match(haystack, haystack_length, 0U, needle, needle_length);
+    while (i != haystack_length) {
+        callback(i, arg);
+        count++;
+        i = ms_next_match(haystack, haystack_length, i + needle_length,
+                          needle, needle_length);
+    }
+
+    return count;
+}
+
+
+/* Replaces all non-overlapping occurences of the character array from in the
+character array str with the character array to. The result is written to
+a new array that has exactly the size required. An empty from has no
+occurences. The returned array must be deallocated with free.
+
+Checks: whether str, from and to are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+from: character array to replace. Must end with null char.
+to: replacement character array. Must end with null char.
+
+Returns: pointer to the new array, or NULL if memory allocation fails */
+char *ms_replace_all(char const str[], char const from[], char const to[]) {
+    size_t i, j, k, count, str_length, from_length, to_length;
+    char *result;
+
+    assert(str);
+    assert(from);
+    assert(to);
+
+    str_length = ms_length(str);
+    from_length = ms_length(from);
+    to_length = ms_length(to);
+    count = ms_find_all(str, from, NULL, 0U);
+
+    result = malloc(str_length - count * from_length + count * to_length + 1);
+    if (!result) {
+        return NULL;
+    }
+
+    /* copy the characters between the occurences followed by to */
+    i = 0U;
+    k = 0U;
+    while (count) {
+        j = ms_next_match(str, str_length, i, from, from_length);
+        while (i != j) {
+            result[k++] = str[i++];
+        }
+        for (j = 0U; j < to_length; j++) {
+            result[k++] = to[j];
+        }
+        i += from_length;
+        count--;
+    }
+
+    /* copy the characters after the last occurence */
+    while (i != str_length) {
+        result[k++] = str[i++];
+    }
+    result[k] = '\0';
+
+    return result;
+}
+
+
+/* Returns the length of the first of the num non-empty character arrays
+from[i] that str begins with and stores its index in pair, or returns
+0 if there is no such array. */
+static size_t ms_match_pair(char const str[], char const *const from[],
+                            size_t num, size_t *pair) {
+    size_t i, j;
+
+    for (i = 0U; i < num; i++) {
+        j = 0U;
+        while (from[i][j] && from[i][j] == str[j]) {
+            j++;
+        }
+
+        /* all characters of a non-empty from[i] are equal */
+        if (!from[i][j] && j) {
+            *pair = i;
+            return j;
+        }
+    }
+
+    return 0U;
+}
+
+
+/* Replaces the occurences of each of the num character arrays from[i] in the
+character array str with the character array to[i], in a single scan of str.
+At each position of str the pairs are tried in order and the first one that
+matches is replaced, then the scan continues after the replaced characters.
+Empty from arrays have no occurences. The result is written to a new array
+that has exactly the size required. The returned array must be deallocated
+with free.
+
+Checks: whether str, from and to are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+from: num character arrays to replace. Each must end with null char.
+to: num replacement character arrays. Each must end with null char.
+num: number of pairs.
+
+Returns: pointer to the new array, or NULL if memory allocation fails */
+char *ms_replace_multi(char const str[], char const *const from[],
+                       char const *const to[], size_t num) {
+    size_t i, j, k, result_length, match_length, pair;
+    char *result;
+
+    assert(str);
+    assert(from);
+    assert(to);
+
+    /* calculate the length of the result */
+    result_length = 0U;
+    i = 0U;
+    while (str[i]) {
+        match_length = ms_match_pair(&str[i], from, num, &pair);
+        if (match_length) {
+            result_length += ms_length(to[pair]);
+            i += match_length;
+        } else {
+            result_length++;
+            i++;
+        }
+    }
+
+    result = malloc(result_length + 1);
+    if (!result) {
+        return NULL;
+    }
+
+    /* copy each character of str unless a replacement begins there */
+    i = 0U;
+    k = 0U;
+    while (str[i]) {
+        match_length = ms_match_pair(&str[i], from, num, &pair);
+        if (match_length) {
+            for (j = 0U; to[pair][j]; j++) {
+                result[k++] = to[pair][j];
+            }
+            i += match_length;
+        } else {
+            result[k++] = str[i++];
+        }
+    }
+    result[k] = '\0';
+
+    return result;
+}
+
+
+/* Kinds of the states of the nondeterministic automaton built from the
+patterns: a state matches a character of a set, or any sequence of
+characters, or it is the final state of a pattern */
+enum ms_glob_kind { MS_GLOB_SET, MS_GLOB_STAR, MS_GLOB_END };
+
+
+/* Set of wildcard patterns compiled to a deterministic finite automaton.
+Characters are mapped to classes of characters that cause the same
+transitions, and the transitions of each state are stored in a row of
+num_classes elements. State 0 is the state that no longer matches. */
+struct ms_glob {
+    unsigned char classes[256];
+    size_t num_classes;
+    size_t num_states;
+    size_t capacity;
+    size_t start;
+    unsigned int *transitions;
+    int *accept;
+};
+
+
+/* Workspace of the subset construction. Each state of the deterministic
+automaton is a set of states of the nondeterministic automaton, stored as
+a bitset of set_bytes bytes in dsets. The hash table buckets contains the
+index of each state plus 1, or 0 for empty buckets. */
+struct ms_glob_builder {
+    unsigned char *kinds;
+    unsigned char *sets;
+    size_t num_nfa_states;
+    size_t set_bytes;
+    unsigned char *dsets;
+    size_t *buckets;
+};
+
+
+/* Parses the token of pattern that begins at position i and stores the
+characters it matches in the 256-bit set. Returns the position of the next
+token, or 0 if the token is a set that is not terminated by ']' or a '\'
+at the end of the pattern. */
+static size_t ms_glob_token(char const pattern[], size_t i,
+                            unsigned char set[]) {
+    size_t first;
+    unsigned int c, last;
+    int negate;
+
+    for (c = 0U; c < 32U; c++) {
+        set[c] = 0U;
+    }
+
+    if (pattern[i] == '*' || pattern[i] == '?') {
+        for (c = 0U; c < 32U; c++) {
+            set[c] = 0xFFU;
+        }
+        return i + 1;
+    }
+
+    if (pattern[i] == '[') {
+        i++;
+        negate = pattern[i] == '!' || pattern[i] == '^';
+        if (negate) {
+            i++;
+        }
+
+        /* a ']' right after the opening bracket is a member of the set */
+        first = i;
+        while (pattern[i] && (pattern[i] != ']' || i == first)) {
+            if (pattern[i] == '\\' && pattern[i+1]) {
+                i++;
+            }
+            c = (unsigned char) pattern[i];
+            last = c;
+            if (pattern[i+1] == '-' && pattern[i+2] && pattern[i+2] != ']') {
+                i += 2;
+                if (pattern[i] == '\\' && pattern[i+1]) {
+                    i++;
+                }
+                last = (unsigned char) pattern[i];
+            }
+            i++;
+            for (; c <= last; c++) {
+                set[c >> 3] |= 1U << (c & 7U);
+            }
+        }
+        if (!pattern[i]) {
+            return 0U;
+        }
+
+        if (negate) {
+            for (c = 0U; c < 32U; c++) {
+                set[c] = (unsigned char) ~set[c];
+            }
+        }
+        return i + 1;
+    }
+
+    /* a '\' escapes the next character, and it cannot end a pattern */
+    if (pattern[i] == '\\') {
+        i++;
+        if (!pattern[i]) {
+            return 0U;
+        }
+    }
+    c = (unsigned char) pattern[i];
+    set[c >> 3] |= 1U << (c & 7U);
+
+    return i + 1;
+}
+
+
+/* Parses the num patterns to a nondeterministic automaton that has one
+state for each token of a pattern followed by a final state. Stores the
+number of states in num_states and, if kinds is not NULL, the kind of each
+state in kinds and the 256-bit set of each state in sets.
+Returns 0 on success, or -1 if a pattern is not valid. */
+static int ms_glob_parse(char const *const patterns[], size_t num,
+                         unsigned char kinds[], unsigned char sets[],
+                         size_t *num_states) {
+    unsigned char set[32];
+    size_t i, j, state;
+
+    state = 0U;
+    for (i = 0U; i < num; i++) {
+        j = 0U;
+        while (patterns[i][j]) {
+            if (kinds) {
+                kinds[state] = patterns[i][j] == '*' ? MS_GLOB_STAR
+                                                     : MS_GLOB_SET;
+            }
+            j = ms_glob_token(patterns[i], j,
+                              kinds ? &sets[state * 32] : set);
+            if (!j) {
+                return -1;
+            }
+            state++;
+        }
+        if (kinds) {
+            kinds[state] = MS_GLOB_END;
+        }
+        state++;
+    }
+    *num_states = state;
+
+    return 0;
+}
+
+
+/* Partitions the 256 characters in classes of characters that belong to
+the same sets of the states of the nondeterministic automaton and stores
+the class of each character in glob.
+
+Returns: the number of classes */
+static size_t ms_glob_classes(ms_glob *glob,
+                              struct ms_glob_builder const *builder) {
+    unsigned int ids[512];
+    size_t state, num_classes, next_num_classes, i;
+    unsigned int c;
+
+    for (c = 0U; c < 256U; c++) {
+        glob->classes[c] = 0U;
+    }
+    num_classes = 1U;
+
+    /* split each class to the characters that belong to the set of a state
+       and the characters that do not */
+    for (state = 0U; state < builder->num_nfa_states; state++) {
+        if (builder->kinds[state] != MS_GLOB_SET) {
+            continue;
+        }
+        for (i = 0U; i < 2 * num_classes; i++) {
+            ids[i] = 256U;
+        }
+        next_num_classes = 0U;
+        for (c = 0U; c < 256U; c++) {
+            i = 2 * glob->classes[c] +
+                ((builder->sets[state * 32 + (c >> 3)] >> (c & 7U)) & 1U);
+            if (ids[i] == 256U) {
+                ids[i] = next_num_classes++;
+            }
+            glob->classes[c] = (unsigned char) ids[i];
+        }
+        num_classes = next_num_classes;
+    }
+
+    return num_classes;
+}
+
+
+/* Adds state to the bitset dset, followed by the states that can be reached
+from it without matching a character. */
+static void ms_glob_closure(unsigned char dset[],
+                            unsigned char const kinds[], size_t state) {
+    dset[state >> 3] |= 1U << (state & 7U);
+    while (kinds[state] == MS_GLOB_STAR) {
+        state++;
+        dset[state >> 3] |= 1U << (state & 7U);
+    }
+}
+
+
+/* Returns the hash of the bitset dset that has set_bytes bytes */
+static size_t ms_glob_hash(unsigned char const dset[], size_t set_bytes) {
+    size_t i, hash;
+
+    hash = 2166136261U;
+    for (i = 0U; i < set_bytes; i++) {
+        hash = (hash ^ dset[i]) * 16777619U;
+    }
+
+    return hash;
+}
+
+
+/* Doubles the capacity of the arrays of the deterministic automaton and
+rebuilds the hash table. Returns 0 on success, or -1 if memory allocation
+fails. */
+static int ms_glob_grow(ms_glob *glob, struct ms_glob_builder *builder) {
+    unsigned char *dsets;
+    unsigned int *transitions;
+    size_t *buckets, capacity, state, i;
+    int *accept;
+
+    capacity = glob->capacity ? 2 * glob->capacity : 16U;
+
+    dsets = realloc(builder->dsets, capacity * builder->set_bytes);
+    if (!dsets) {
+        return -1;
+    }
+    builder->dsets = dsets;
+
+    transitions = realloc(glob->transitions,
+                          capacity * glob->num_classes * sizeof *transitions);
+    if (!transitions) {
+        return -1;
+    }
+    glob->transitions = transitions;
+
+    accept = realloc(glob->accept, capacity * sizeof *accept);
+    if (!accept) {
+        return -1;
+    }
+    glob->accept = accept;
+
+    buckets = realloc(builder->buckets, 2 * capacity * sizeof *buckets);
+    if (!buckets) {
+        return -1;
+    }
+    builder->buckets = buckets;
+    glob->capacity = capacity;
+
+    /* insert the existing states in the hash table */
+    for (i = 0U; i < 2 * capacity; i++) {
+        buckets[i] = 0U;
+    }
+    for (state = 0U; state < glob->num_states; state++) {
+        i = ms_glob_hash(&dsets[state * builder->set_bytes],
+                         builder->set_bytes) & (2 * capacity - 1);
+        while (buckets[i]) {
+            i = (i + 1) & (2 * capacity - 1);
+        }
+        buckets[i] = state + 1;
+    }
+
+    return 0;
+}
+
+
+/* Finds the state of the deterministic automaton that corresponds to the
+bitset dset, or adds it if it does not exist, and stores it in state.
+Returns 0 on success, or -1 if the automaton would have more than
+MS_GLOB_MAX_STATES states or memory allocation fails. */
+static int ms_glob_state(ms_glob *glob, struct ms_glob_builder *builder,
+                         unsigned char const dset[], size_t *state) {
+    unsigned char const *found;
+    size_t i, j, mask, nfa_state;
+    int pattern;
+
+    if (glob->num_states == glob->capacity &&
+        ms_glob_grow(glob, builder)) {
+        return -1;
+    }
+
+    /* search the hash table */
+    mask = 2 * glob->capacity - 1;
+    i = ms_glob_hash(dset, builder->set_bytes) & mask;
+    while (builder->buckets[i]) {
+        found = &builder->dsets[(builder->buckets[i] - 1) *
+                                builder->set_bytes];
+        j = 0U;
+        while (j < builder->set_bytes && dset[j] == found[j]) {
+            j++;
+        }
+        if (j == builder->set_bytes) {
+            *state = builder->buckets[i] - 1;
+            return 0;
+        }
+        i = (i + 1) & mask;
+    }
+
+    /* add a new state */
+    if (glob->num_states == MS_GLOB_MAX_STATES) {
+        return -1;
+    }
+    *state = glob->num_states++;
+    builder->buckets[i] = glob->num_states;
+    for (j = 0U; j < builder->set_bytes; j++) {
+        builder->dsets[*state * builder->set_bytes + j] = dset[j];
+    }
+
+    /* the state accepts the first pattern whose final state it contains */
+    glob->accept[*state] = -1;
+    pattern = 0;
+    for (nfa_state = 0U; nfa_state < builder->num_nfa_states; nfa_state++) {
+        if (builder->kinds[nfa_state] != MS_GLOB_END) {
+            continue;
+        }
+        if (dset[nfa_state >> 3] & (1U << (nfa_state & 7U))) {
+            glob->accept[*state] = pattern;
+            break;
+        }
+        pattern++;
+    }
+
+    return 0;
+}
+
+
+/* Builds the states of the deterministic automaton with the subset
+construction, starting from the state that no longer matches and the
+start state. Returns 0 on success, or -1 if the automaton would have more
+than MS_GLOB_MAX_STATES states or memory allocation fails. */
+static int ms_glob_build(ms_glob *glob, struct ms_glob_builder *builder,
+                         unsigned char dset[]) {
+    unsigned char representatives[256];
+    unsigned char const *current, *set;
+    size_t state, next, nfa_state, i;
+    unsigned int c;
+
+    for (i = 0U; i < builder->set_bytes; i++) {
+        dset[i] = 0U;
+    }
+    if (ms_glob_state(glob, builder, dset, &state)) {
+        return -1;
+    }
+
+    /* the start state contains the first state of each pattern */
+    if (builder->num_nfa_states) {
+        ms_glob_closure(dset, builder->kinds, 0U);
+        for (nfa_state = 0U; nfa_state + 1 < builder->num_nfa_states;
+             nfa_state++) {
+            if (builder->kinds[nfa_state] == MS_GLOB_END) {
+                ms_glob_closure(dset, builder->kinds, nfa_state + 1);
+            }
+        }
+        if (ms_glob_state(glob, builder, dset, &glob->start)) {
+            return -1;
+        }
+    }
+
+    /* any character of a class causes the same transitions */
+    for (c = 256U; c; c--) {
+        representatives[glob->classes[c - 1]] = (unsigned char) (c - 1);
+    }
+
+    for (state = 0U; state < glob->num_states; state++) {
+        for (i = 0U; i < glob->num_classes; i++) {
+            c = representatives[i];
+            for (next = 0U; next < builder->set_bytes; next++) {
+                dset[next] = 0U;
+            }
+
+            /* dsets can move when a state is added */
+            current = &builder->dsets[state * builder->set_bytes];
+            for (nfa_state = 0U; nfa_state < builder->num_nfa_states;
+                 nfa_state++) {
+                if (!(current[nfa_state >> 3] & (1U << (nfa_state & 7U)))) {
+                    continue;
+                }
+                set = &builder->sets[nfa_state * 32];
+                if (builder->kinds[nfa_state] == MS_GLOB_STAR) {
+                    ms_glob_closure(dset, builder->kinds, nfa_state);
+                } else if (builder->kinds[nfa_state] == MS_GLOB_SET &&
+                           (set[c >> 3] & (1U << (c & 7U)))) {
+                    ms_glob_closure(dset, builder->kinds, nfa_state + 1);
+                }
+            }
+
+            if (ms_glob_state(glob, builder, dset, &next)) {
+                return -1;
+            }
+            glob->transitions[state * glob->num_classes + i] =
+                (unsigned int) next;
+        }
+    }
+
+    return 0;
+}
+
+
+/* Compiles the num wildcard patterns to a deterministic finite automaton
+that can be used by ms_glob_match. In a pattern, '*' matches any sequence
+of characters, '?' matches any character, and [set] matches any character
+in set. A set can contain ranges such as a-z, it is negated when it begins
+with '!' or '^', and a ']' is a member of the set if it is the first
+character of the set. A '\' followed by a character matches that character,
+also inside a set. Every other character matches itself. The result must be
+deallocated with ms_glob_free.
+
+Checks: whether patterns is NULL at runtime.
+
+Parameters:
+patterns: num character arrays. Each must end with null char.
+num: number of patterns.
+
+Returns: pointer to the compiled patterns, or NULL if a pattern has a
+set that is not terminated by ']' or ends with a single '\', the automaton
+needs more than MS_GLOB_MAX_STATES states, or memory allocation fails */
+ms_glob *ms_glob_compile(char const *const patterns[], size_t num) {
+    struct ms_glob_builder builder;
+    unsigned char *dset;
+    ms_glob *glob;
+    int error;
+
+    assert(patterns);
+
+    if (ms_glob_parse(patterns, num, NULL, NULL, &builder.num_nfa_states)) {
+        return NULL;
+    }
+
+    glob = malloc(sizeof *glob);
+    if (!glob) {
+        return NULL;
+    }
+    glob->num_states = 0U;
+    glob->capacity = 0U;
+    glob->start = 0U;
+    glob->transitions = NULL;
+    glob->accept = NULL;
+
+    builder.set_bytes = builder.num_nfa_states / 8 + 1;
+    builder.kinds = malloc(builder.num_nfa_states + 1);
+    builder.sets = malloc(builder.num_nfa_states * 32 + 1);
+    builder.dsets = NULL;
+    builder.buckets = NULL;
+    dset = malloc(builder.set_bytes);
+
+    error = !builder.kinds || !builder.sets || !dset;
+    if (!error) {
+        ms_glob_parse(patterns, num, builder.kinds, builder.sets,
+                      &builder.num_nfa_states);
+        glob->num_classes = ms_glob_classes(glob, &builder);
+        error = ms_glob_build(glob, &builder, dset);
+    }
+
+    free(builder.kinds);
+    free(builder.sets);
+    free(builder.dsets);
+    free(builder.buckets);
+    free(dset);
+
+    if (error) {
+        ms_glob_free(glob);
+        return NULL;
+    }
+
+    return glob;
+}
+
+
+/* Matches the character array str against the compiled patterns glob in
+time proportional to the length of str. The whole str must match.
+
+Checks: whether glob and str are NULL at runtime.
+
+Parameters:
+glob: compiled patterns returned by ms_glob_compile.
+str: character array. Must end with null char.
+
+Returns: the index of the first pattern that matches str, or -1 if no
+pattern matches str */
+int ms_glob_match(ms_glob const *glob, char const str[]) {
+    size_t i, state;
+
+    assert(glob);
+    assert(str);
+
+    /* stop early if the state no longer matches */
+    state = glob->start;
+    for (i = 0U; str[i] && state; i++) {
+        state = glob->transitions[state * glob->num_classes +
+                                  glob->classes[(unsigned char) str[i]]];
+    }
+
+    return glob->accept[state];
+}
+
+
+/* Deallocates the compiled patterns glob.
+
+Checks: whether glob is NULL at runtime.
+
+Parameters:
+glob: compiled patterns returned by ms_glob_compile. */
+void ms_glob_free(ms_glob *glob) {
+    assert(glob);
+
+    free(glob->transitions);
+    free(glob->accept);
+    free(glob);
+}
+
+
+/* Flags of the characters in a set: members of the set, and characters that
+stop a scan for characters not in the set, which also include the null
+character */
+enum ms_byteset_flag { MS_BYTESET_MEMBER = 1, MS_BYTESET_STOP = 2 };
+
+
+/* Finds the first occurence of the character c (converted to char) in the
+character array str. The terminating null character is considered part of
+str, so it is found if c is 0.
+
+Checks: whether array is NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+c: character to find.
+
+Returns: if c is found a pointer to it, else NULL */
+char *ms_find_char(char const str[], int c) {
+    size_t i;
+    char ch;
+
+    assert(str);
+
+    ch = (char) c;
+    i = 0U;
+    while (str[i] != ch) {
+        if (!str[i]) {
+            return NULL;
+        }
+        i++;
+    }
+
+    return (char *) &str[i];
+}
+
+
+/* Finds the last occurence of the character c (converted to char) in the
+character array str. The terminating null character is considered part of
+str, so it is found if c is 0.
+
+Checks: whether array is NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+c: character to find.
+
+Returns: if c is found a pointer to it, else NULL */
+char *ms_rfind_char(char const str[], int c) {
+    size_t i;
+    char ch;
+
+    assert(str);
+
+    /* search backwards from the null character */
+    ch = (char) c;
+    i = ms_length(str) + 1;
+    while (i) {
+        i--;
+        if (str[i] == ch) {
+            return (char *) &str[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+/* Builds the set of the characters in the character array set.
+
+Checks: whether byteset and set are NULL at runtime.
+
+Parameters:
+byteset: set to build.
+set: character array. Must end with null char. */
+void ms_byteset_init(ms_byteset *byteset, char const set[]) {
+    size_t i;
+
+    assert(byteset);
+    assert(set);
+
+    for (i = 0U; i < 256U; i++) {
+        byteset->members[i] = 0U;
+    }
+
+    byteset->members[0] = MS_BYTESET_STOP;
+    for (i = 0U; set[i]; i++) {
+        byteset->members[(unsigned char) set[i]] = MS_BYTESET_MEMBER |
+                                                   MS_BYTESET_STOP;
+    }
+}
+
+
+/* Finds the first character of the character array str that is in the
+character array set. The terminating null characters are not compared.
+
+Checks: whether both arrays are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+set: character array. Must end with null char.
+
+Returns: if a character is found a pointer to it, else NULL */
+char *ms_find_any(char const str[], char const set[]) {
+    ms_byteset byteset;
+
+    assert(str);
+    assert(set);
+
+    ms_byteset_init(&byteset, set);
+
+    return ms_find_any_byteset(str, &byteset);
+}
+
+
+/* Finds the first character of the character array str that is in the set
+byteset. The terminating null character is not compared.
+
+Checks: whether str and byteset are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+byteset: set built by ms_byteset_init.
+
+Returns: if a character is found a pointer to it, else NULL */
+char *ms_find_any_byteset(char const str[], ms_byteset const *byteset) {
+    size_t i;
+
+    assert(str);
+    assert(byteset);
+
+    i = ms_cspan_byteset(str, byteset);
+
+    return str[i] ? (char *) &str[i] : NULL;
+}
+
+
+/* Calculates the length of the initial part of the character array str
+that consists only of characters in the character array set.
+
+Checks: whether both arrays are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+set: character array. Must end with null char.
+
+Returns: length of the initial part of str */
+size_t ms_span(char const str[], char const set[]) {
+    ms_byteset byteset;
+
+    assert(str);
+    assert(set);
+
+    ms_byteset_init(&byteset, set);
+
+    return ms_span_byteset(str, &byteset);
+}
+
+
+/* Calculates the length of the initial part of the character array str
+that consists only of characters in the set byteset.
+
+Checks: whether str and byteset are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+byteset: set built by ms_byteset_init.
+
+Returns: length of the initial part of str */
+size_t ms_span_byteset(char const str[], ms_byteset const *byteset) {
+    size_t i;
+
+    assert(str);
+    assert(byteset);
+
+    /* the null character is not a member of the set */
+    i = 0U;
+    while (byteset->members[(unsigned char) str[i]] & MS_BYTESET_MEMBER) {
+        i++;
+    }
+
+    return i;
+}
+
+
+/* Calculates the length of the initial part of the character array str
+that consists only of characters not in the character array set.
+
+Checks: whether both arrays are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+set: character array. Must end with null char.
+
+Returns: length of the initial part of str */
+size_t ms_cspan(char const str[], char const set[]) {
+    ms_byteset byteset;
+
+    assert(str);
+    assert(set);
+
+    ms_byteset_init(&byteset, set);
+
+    return ms_cspan_byteset(str, &byteset);
+}
+
+
+/* Calculates the length of the initial part of the character array str
+that consists only of characters not in the set byteset.
+
+Checks: whether str and byteset are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+byteset: set built by ms_byteset_init.
+
+Returns: length of the initial part of str */
+size_t ms_cspan_byteset(char const str[], ms_byteset const *byteset) {
+    size_t i;
+
+    assert(str);
+    assert(byteset);
+
+    /* stop at a member of the set or at the null character */
+    i = 0U;
+    while (!(byteset->members[(unsigned char) str[i]] & MS_BYTESET_STOP)) {
+        i++;
+    }
+
+    return i;
+}
+
+
+/* Number of bits of the words used by the bit-parallel edit distance */
+#define MS_WORD_BITS (sizeof(unsigned long) * CHAR_BIT)
+
+
+/* State of the bit-parallel algorithm of Myers for the edit distance of a
+pattern of length characters. The rows of the dynamic programming matrix
+are split in num_blocks blocks of MS_WORD_BITS rows. For each character c,
+peq[c * num_blocks + b] has the bits of the rows of block b whose pattern
+character is c. pv and mv have the bits of the rows of each block whose
+vertical difference in the current column is +1 and -1 respectively, and
+score is the value of the last row. Patterns that fit in one block use the
+storage in small instead of allocating memory. */
+struct ms_myers {
+    size_t num_blocks;
+    size_t score;
+    unsigned long last_bit;
+    unsigned long *peq;
+    unsigned long *pv;
+    unsigned long *mv;
+    unsigned long small[258];
+};
+
+
+/* Initializes the state for the first column of the matrix of the pattern
+that begins at pattern and has length > 0 characters. The pattern is read
+backwards from its last character if reverse is not 0.
+Returns 0 on success, or -1 if memory allocation fails. */
+static int ms_myers_init(struct ms_myers *myers, char const pattern[],
+                         size_t length, int reverse) {
+    size_t num_blocks, row, i;
+
+    num_blocks = (length + MS_WORD_BITS - 1) / MS_WORD_BITS;
+    if (num_blocks == 1) {
+        myers->peq = myers->small;
+    } else {
+        myers->peq = malloc(258 * num_blocks * sizeof *myers->peq);
+        if (!myers->peq) {
+            return -1;
+        }
+    }
+    myers->num_blocks = num_blocks;
+    myers->pv = myers->peq + 256 * num_blocks;
+    myers->mv = myers->pv + num_blocks;
+    myers->last_bit = 1UL << (length - 1) % MS_WORD_BITS;
+
+    /* the first column has value i in row i */
+    myers->score = length;
+    for (i = 0U; i < 256 * num_blocks; i++) {
+        myers->peq[i] = 0UL;
+    }
+    for (i = 0U; i < num_blocks; i++) {
+        myers->pv[i] = ~0UL;
+        myers->mv[i] = 0UL;
+    }
+
+    for (row = 0U; row < length; row++) {
+        i = reverse ? length - 1 - row : row;
+        myers->peq[(unsigned char) pattern[i] * num_blocks +
+                   row / MS_WORD_BITS] |= 1UL << row % MS_WORD_BITS;
+    }
+
+    return 0;
+}
+
+
+/* Deallocates the memory of the state, if any */
+static void ms_myers_free(struct ms_myers *myers) {
+    if (myers->peq != myers->small) {
+        free(myers->peq);
+    }
+}
+
+
+/* Calculates the next column of the matrix for the text character c.
+hin is the horizontal difference of the first row, which is 0 when the
+pattern can begin anywhere in the text, or 1 when it must begin at the
+first character of the text. */
+static void ms_myers_step(struct ms_myers *myers, char c, int hin) {
+    unsigned long eq, pv, mv, xv, xh, ph, mh, bit;
+    unsigned long const *peq;
+    size_t block;
+    int hout;
+
+    peq = &myers->peq[(unsigned char) c * myers->num_blocks];
+    for (block = 0U; block < myers->num_blocks; block++) {
+        eq = peq[block];
+        pv = myers->pv[block];
+        mv = myers->mv[block];
+
+        xv = eq | mv;
+        if (hin < 0) {
+            eq |= 1UL;
+        }
+        xh = (((eq & pv) + pv) ^ pv) | eq;
+        ph = mv | ~(xh | pv);
+        mh = pv & xh;
+
+        /* the horizontal difference of the last row of the block is
+           passed to the next block, or it updates the score */
+        bit = block + 1 == myers->num_blocks ? myers->last_bit
+                                             : 1UL << (MS_WORD_BITS - 1);
+        hout = (ph & bit) ? 1 : (mh & bit) ? -1 : 0;
+
+        ph <<= 1;
+        mh <<= 1;
+        if (hin < 0) {
+            mh |= 1UL;
+        } else if (hin > 0) {
+            ph |= 1UL;
+        }
+        myers->pv[block] = mh | ~(xv | ph);
+        myers->mv[block] = ph & xv;
+        hin = hout;
+    }
+
+    if (hin > 0) {
+        myers->score++;
+    } else if (hin < 0) {
+        myers->score--;
+    }
+}
+
+
+/* Finds the first approximate occurence of the character array needle in
+the character array haystack, that is a part of haystack whose edit
+distance from needle is at most k. The edit distance is the minimum number
+of characters that must be inserted, deleted or substituted. The occurence
+that ends first is extended while its distance decreases, and among the
+parts of haystack that end there the one with the lowest distance is
+returned. Runs in time proportional to the length of haystack times the
+number of machine words needed for the bits of needle.
+
+Checks: whether haystack and needle are NULL at runtime.
+
+Parameters:
+haystack: character array. Must end with null char.
+needle: character array. Must end with null char.
+k: maximum edit distance.
+match_length: receives the length of the occurence. Can be NULL.
+
+Returns: if an occurence is found a pointer to it, else NULL. Also returns
+NULL if memory allocation fails */
+char *ms_fuzzy_search(char const haystack[], char const needle[], size_t k,
+                      size_t *match_length) {
+    struct ms_myers myers;
+    size_t i, start, end, needle_length, score;
+
+    assert(haystack);
+    assert(needle);
+
+    needle_length = ms_length(needle);
+    if (needle_length <= k) {
+        if (match_length) {
+            *match_length = 0U;
+        }
+        return (char *) haystack;
+    }
+
+    if (ms_myers_init(&myers, needle, needle_length, 0)) {
+        return NULL;
+    }
+
+    /* find where the first occurence ends, the needle can begin anywhere */
+    end = 0U;
+    while (haystack[end] && myers.score > k) {
+        ms_myers_step(&myers, haystack[end], 0);
+        end++;
+    }
+    if (myers.score > k) {
+        ms_myers_free(&myers);
+        return NULL;
+    }
+
+    /* extend the occurence while its distance decreases */
+    score = myers.score;
+    while (haystack[end]) {
+        ms_myers_step(&myers, haystack[end], 0);
+        if (myers.score >= score) {
+            break;
+        }
+        score = myers.score;
+        end++;
+    }
+    ms_myers_free(&myers);
+
+    /* find the beginning with the reversed needle that must begin at
+       end, the occurence has at most needle_length + k characters */
+    if (ms_myers_init(&myers, needle, needle_length, 1)) {
+        return NULL;
+    }
+    start = end;
+    score = myers.score;
+    for (i = end; i && end - i < needle_length + k; i--) {
+        ms_myers_step(&myers, haystack[i-1], 1);
+        if (myers.score < score) {
+            score = myers.score;
+            start = i - 1;
+        }
+    }
+    ms_myers_free(&myers);
+
+    if (match_length) {
+        *match_length = end - start;
+    }
+
+    return (char *) &haystack[start];
+}
+
+
+/* Calculates the edit distance of the character arrays str1 and str2, that
+is the minimum number of characters that must be inserted, deleted or
+substituted in order to change str1 to str2. Stops early once the distance
+is known to be larger than max_distance.
+
+Checks: whether both arrays are NULL at runtime.
+
+Parameters:
+str1: character array. Must end with null char.
+str2: character array. Must end with null char.
+max_distance: maximum edit distance of interest. Values larger than
+(size_t) -3 are treated as (size_t) -3, so that the results below differ.
+
+Returns: the edit distance if it is at most max_distance, else
+max_distance + 1. Returns (size_t) -1 if memory allocation fails */
+size_t ms_edit_distance(char const str1[], char const str2[],
+                        size_t max_distance) {
+    struct ms_myers myers;
+    size_t i, length1, length2, remaining;
+    char const *pattern, *text;
+
+    assert(str1);
+    assert(str2);
+
+    /* max_distance + 1 must not wrap to 0 or equal (size_t) -1 */
+    if (max_distance > (size_t) -3) {
+        max_distance = (size_t) -3;
+    }
+
+    /* the distance is at least the difference of the lengths */
+    length1 = ms_length(str1);
+    length2 = ms_length(str2);
+    if ((length1 > length2 ? length1 - length2 : length2 - length1) >
+        max_distance) {
+        return max_distance + 1;
+    }
+
+    /* the shorter array is the pattern */
+    pattern = str1;
+    text = str2;
+    if (length1 > length2) {
+        pattern = str2;
+        text = str1;
+        remaining = length1;
+        length1 = length2;
+    } else {
+        remaining = length2;
+    }
+    if (!length1) {
+        return remaining;
+    }
+
+    if (ms_myers_init(&myers, pattern, length1, 0)) {
+        return (size_t) -1;
+    }
+
+    /* the pattern must begin at the first character of the text. Each
+       remaining character of the text decreases the score by at most 1 */
+    for (i = 0U; text[i]; i++) {
+        ms_myers_step(&myers, text[i], 1);
+        remaining--;
+        if (myers.score > remaining &&
+            myers.score - remaining > max_distance) {
+            ms_myers_free(&myers);
+            return max_distance + 1;
+        }
+    }
+    ms_myers_free(&myers);
+
+    return myers.score;
+}
+
+
+/* Layout of a table of sorted character arrays. All numbers of the header
+and the index are stored in 4 bytes, least significant byte first, and the
+numbers of the blocks in 7-bit groups, least significant group first, with
+the high bit set in all groups but the last.
+
+header: "MSTB", block size, count of arrays, count of blocks, length of the
+longest array, size of the blocks in bytes
+index: offset of each block from the beginning of the blocks
+blocks: for each array, the number of characters it shares with the
+previous array of the block, the number of the rest of its characters and
+the rest of its characters, followed by a null byte that stops compares at
+the end of the table */
+#define MS_STRTAB_HEADER_SIZE 24
+#define MS_STRTAB_MAX_SIZE 0xFFFFFFFFUL
+
+
+/* Builder of a table of sorted character arrays. blocks and offsets grow as
+arrays are added, and last has a copy of the last array added. */
+struct ms_strtab_builder {
+    size_t block_size;
+    size_t count;
+    size_t max_length;
+    unsigned char *blocks;
+    size_t blocks_size;
+    size_t blocks_capacity;
+    unsigned long *offsets;
+    size_t num_blocks;
+    size_t offsets_capacity;
+    char *last;
+    size_t last_capacity;
+};
+
+
+/* Table of sorted character arrays, see the layout above */
+struct ms_strtab {
+    unsigned char const *index;
+    unsigned char const *blocks;
+    size_t block_size;
+    size_t count;
+    size_t num_blocks;
+    size_t max_length;
+};
+
+
+/* Returns the number stored in the 4 bytes at bytes */
+static unsigned long ms_strtab_number(unsigned char const bytes[]) {
+    return (unsigned long) bytes[0] | (unsigned long) bytes[1] << 8 |
+           (unsigned long) bytes[2] << 16 | (unsigned long) bytes[3] << 24;
+}
+
+
+/* Stores number in the 4 bytes at bytes */
+static void ms_strtab_put_number(unsigned char bytes[], unsigned long number) {
+    bytes[0] = (unsigned char) (number & 0xFFU);
+    bytes[1] = (unsigned char) (number >> 8 & 0xFFU);
+    bytes[2] = (unsigned char) (number >> 16 & 0xFFU);
+    bytes[3] = (unsigned char) (number >> 24 & 0xFFU);
+}
+
+
+/* Reads the number stored in 7-bit groups at bytes into number and
+returns a pointer to the next byte */
+static unsigned char const *ms_strtab_varint(unsigned char const bytes[],
+                                             size_t *number) {
+    unsigned int shift;
+    size_t i;
+
+    *number = 0U;
+    shift = 0U;
+    for (i = 0U; bytes[i] & 0x80U; i++) {
+        *number |= (size_t) (bytes[i] & 0x7FU) << shift;
+        shift += 7U;
+    }
+    *number |= (size_t) bytes[i] << shift;
+
+    return &bytes[i+1];
+}
+
+
+/* Makes sure that the blocks of the builder can receive num more bytes.
+Returns 0 on success, or -1 if the table would exceed its maximum size or
+memory allocation fails. */
+static int ms_strtab_reserve(ms_strtab_builder *builder, size_t num) {
+    unsigned char *blocks;
+    size_t capacity;
+
+    if (num > MS_STRTAB_MAX_SIZE - builder->blocks_size) {
+        return -1;
+    }
+    if (builder->blocks_size + num <= builder->blocks_capacity) {
+        return 0;
+    }
+
+    capacity = 2 * builder->blocks_capacity + num;
+    blocks = realloc(builder->blocks, capacity);
+    if (!blocks) {
+        return -1;
+    }
+    builder->blocks = blocks;
+    builder->blocks_capacity = capacity;
+
+    return 0;
+}
+
+
+/* Appends number to the blocks of the builder in 7-bit groups. There must
+be enough space for it. */
+static void ms_strtab_put_varint(ms_strtab_builder *builder, size_t number) {
+    while (number >= 0x80U) {
+        builder->blocks[builder->blocks_size++] =
+            (unsigned char) (number & 0x7FU) | 0x80U;
+        number >>= 7;
+    }
+    builder->blocks[builder->blocks_size++] = (unsigned char) number;
+}
+
+
+/* Creates a builder of a table with block_size character arrays in each
+block. Larger blocks need less memory for the index, but lookups decode
+more arrays. The result must be deallocated with ms_strtab_builder_free.
+
+Checks: whether block_size is 0 at runtime.
+
+Parameters:
+block_size: number of character arrays in each block.
+
+Returns: pointer to the builder, or NULL if memory allocation fails */
+ms_strtab_builder *ms_strtab_builder_new(size_t block_size) {
+    ms_strtab_builder *builder;
+
+    assert(block_size);
+
+    builder = malloc(sizeof *builder);
+    if (!builder) {
+        return NULL;
+    }
+    builder->block_size = block_size;
+    builder->count = 0U;
+    builder->max_length = 0U;
+    builder->blocks = NULL;
+    builder->blocks_size = 0U;
+    builder->blocks_capacity = 0U;
+    builder->offsets = NULL;
+    builder->num_blocks = 0U;
+    builder->offsets_capacity = 0U;
+    builder->last = NULL;
+    builder->last_capacity = 0U;
+
+    return builder;
+}
+
+
+/* Adds the character array str to the table. Arrays must be added in
+strictly ascending order according to ms_compare.
+
+Checks: whether builder and str are NULL at runtime.
+
+Parameters:
+builder: builder returned by ms_strtab_builder_new.
+str: character array. Must end with null char.
+
+Returns: 0 on success, or -1 if str is not greater than the previous
+array, the table exceeds 4 GiB, or memory allocation fails */
+int ms_strtab_builder_add(ms_strtab_builder *builder, char const str[]) {
+    unsigned long *offsets;
+    size_t i, length, prefix, capacity;
+    char *last;
+
+    assert(builder);
+    assert(str);
+
+    if (builder->count && ms_compare(builder->last, str) >= 0) {
+        return -1;
+    }
+    length = ms_length(str);
+
+    /* the first array of a block begins a new block and shares nothing */
+    prefix = 0U;
+    if (builder->count % builder->block_size == 0) {
+        if (builder->num_blocks == builder->offsets_capacity) {
+            capacity = 2 * builder->offsets_capacity + 16;
+            offsets = realloc(builder->offsets, capacity * sizeof *offsets);
+            if (!offsets) {
+                return -1;
+            }
+            builder->offsets = offsets;
+            builder->offsets_capacity = capacity;
+        }
+    } else {
+        while (str[prefix] && str[prefix] == builder->last[prefix]) {
+            prefix++;
+        }
+    }
+
+    /* keep a copy of str to compare it with the next array */
+    if (length >= builder->last_capacity) {
+        capacity = 2 * length + 1;
+        last = realloc(builder->last, capacity);
+        if (!last) {
+            return -1;
+        }
+        builder->last = last;
+        builder->last_capacity = capacity;
+    }
+
+    /* 2 numbers of at most 10 bytes, the characters and a null byte */
+    if (ms_strtab_reserve(builder, 2 * 10 + length - prefix + 1)) {
+        return -1;
+    }
+    if (builder->count % builder->block_size == 0) {
+        builder->offsets[builder->num_blocks++] = builder->blocks_size;
+    }
+    ms_strtab_put_varint(builder, prefix);
+    ms_strtab_put_varint(builder, length - prefix);
+    for (i = prefix; i < length; i++) {
+        builder->blocks[builder->blocks_size++] = (unsigned char) str[i];
+    }
+
+    ms_copy(builder->last, str);
+    if (length > builder->max_length) {
+        builder->max_length = length;
+    }
+    builder->count++;
+
+    return 0;
+}
+
+
+/* Writes the table to file.
+
+Checks: whether builder and file are NULL at runtime.
+
+Parameters:
+builder: builder returned by ms_strtab_builder_new.
+file: file opened for writing in binary mode.
+
+Returns: 0 on success, or -1 if writing fails */
+int ms_strtab_builder_write(ms_strtab_builder const *builder, FILE *file) {
+    unsigned char header[MS_STRTAB_HEADER_SIZE], number[4];
+    size_t i;
+
+    assert(builder);
+    assert(file);
+
+    header[0] = 'M';
+    header[1] = 'S';
+    header[2] = 'T';
+    header[3] = 'B';
+    ms_strtab_put_number(&header[4], builder->block_size);
+    ms_strtab_put_number(&header[8], builder->count);
+    ms_strtab_put_number(&header[12], builder->num_blocks);
+    ms_strtab_put_number(&header[16], builder->max_length);
+    ms_strtab_put_number(&header[20], builder->blocks_size + 1);
+    if (fwrite(header, 1, sizeof header, file) != sizeof header) {
+        return -1;
+    }
+
+    for (i = 0U; i < builder->num_blocks; i++) {
+        ms_strtab_put_number(number, builder->offsets[i]);
+        if (fwrite(number, 1, sizeof number, file) != sizeof number) {
+            return -1;
+        }
+    }
+
+    /* the blocks are followed by a null byte */
+    if ((builder->blocks_size &&
+         fwrite(builder->blocks, 1, builder->blocks_size, file) !=
+         builder->blocks_size) || fputc('\0', file) == EOF) {
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/* Deallocates the builder.
+
+Checks: whether builder is NULL at runtime.
+
+Parameters:
+builder: builder returned by ms_strtab_builder_new. */
+void ms_strtab_builder_free(ms_strtab_builder *builder) {
+    assert(builder);
+
+    free(builder->blocks);
+    free(builder->offsets);
+    free(builder->last);
+    free(builder);
+}
+
+
+/* Opens the table that has been written by ms_strtab_builder_write and
+occupies the size bytes at data. Only the header of the table is checked,
+and data is used in place, so it must remain valid and unchanged until
+ms_strtab_close. It can be a read-only memory mapping of the file.
+The result must be deallocated with ms_strtab_close.
+
+Checks: whether data is NULL at runtime.
+
+Parameters:
+data: contents of the table.
+size: number of bytes of data.
+
+Returns: pointer to the table, or NULL if data is not a table or memory
+allocation fails */
+ms_strtab *ms_strtab_open(void const *data, size_t size) {
+    unsigned char const *bytes;
+    size_t block_size, count, num_blocks, blocks_size;
+    ms_strtab *tab;
+
+    assert(data);
+
+    bytes = data;
+    if (size < MS_STRTAB_HEADER_SIZE || bytes[0] != 'M' || bytes[1] != 'S' ||
+        bytes[2] != 'T' || bytes[3] != 'B' || bytes[size - 1]) {
+        return NULL;
+    }
+    block_size = ms_strtab_number(&bytes[4]);
+    count = ms_strtab_number(&bytes[8]);
+    num_blocks = ms_strtab_number(&bytes[12]);
+    blocks_size = ms_strtab_number(&bytes[20]);
+
+    /* the sizes must agree with the counts */
+    if (!block_size || num_blocks != (count + block_size - 1) / block_size ||
+        !blocks_size || (size - MS_STRTAB_HEADER_SIZE) / 4 < num_blocks ||
+        size - MS_STRTAB_HEADER_SIZE - 4 * num_blocks != blocks_size) {
+        return NULL;
+    }
+
+    tab = malloc(sizeof *tab);
+    if (!tab) {
+        return NULL;
+    }
+    tab->index = &bytes[MS_STRTAB_HEADER_SIZE];
+    tab->blocks = tab->index + 4 * num_blocks;
+    tab->block_size = block_size;
+    tab->count = count;
+    tab->num_blocks = num_blocks;
+    tab->max_length = ms_strtab_number(&bytes[16]);
+
+    return tab;
+}
+
+
+/* Returns the number of character arrays in the table tab.
+
+Checks: whether tab is NULL at runtime.
+
+Parameters:
+tab: table returned by ms_strtab_open.
+
+Returns: number of character arrays */
+size_t ms_strtab_count(ms_strtab const *tab) {
+    assert(tab);
+
+    return tab->count;
+}
+
+
+/* Returns the length of the longest character array in the table tab.
+
+Checks: whether tab is NULL at runtime.
+
+Parameters:
+tab: table returned by ms_strtab_open.
+
+Returns: length of the longest character array */
+size_t ms_strtab_max_length(ms_strtab const *tab) {
+    assert(tab);
+
+    return tab->max_length;
+}
+
+
+/* Finds the character array key in the table tab with a binary search of
+the blocks followed by a scan of one block.
+
+Checks: whether tab and key are NULL at runtime.
+
+Parameters:
+tab: table returned by ms_strtab_open.
+key: character array. Must end with null char.
+index: receives the position of key in the table. Can be NULL.
+
+Returns: 1 if key is found, else 0 */
+int ms_strtab_find(ms_strtab const *tab, char const key[], size_t *index) {
+    unsigned char const *bytes;
+    size_t i, low, high, middle, length, prefix, match, entry, entries;
+    int result;
+
+    assert(tab);
+    assert(key);
+
+    if (!tab->count) {
+        return 0;
+    }
+
+    /* find the last block whose first array is not greater than key. The
+       first array of a block shares no characters, so it begins with a
+       single 0 byte */
+    low = 0U;
+    high = tab->num_blocks;
+    while (high - low > 1) {
+        middle = low + (high - low) / 2;
+        bytes = &tab->blocks[ms_strtab_number(&tab->index[4 * middle])];
+        bytes = ms_strtab_varint(&bytes[1], &length);
+        result = ms_ncompare(key, (char const *) bytes, length);
+
+        /* if the first length characters are equal, compare the next
+           character of key with the end of the array */
+        if (result < 0 || (!result && key[length] < '\0')) {
+            high = middle;
+        } else {
+            low = middle;
+        }
+    }
+
+    /* scan the block, match is the number of characters that the
+       current array shares with key */
+    bytes = &tab->blocks[ms_strtab_number(&tab->index[4 * low])];
+    entries = tab->count - low * tab->block_size;
+    if (entries > tab->block_size) {
+        entries = tab->block_size;
+    }
+    match = 0U;
+    for (entry = 0U; entry < entries; entry++) {
+        bytes = ms_strtab_varint(bytes, &prefix);
+        bytes = ms_strtab_varint(bytes, &length);
+
+        /* an array that shares more characters with the previous array
+           than key is still less than key, one that shares fewer is
+           greater than key */
+        if (prefix < match) {
+            return 0;
+        }
+        if (prefix == match) {
+            i = 0U;
+            while (i < length && (char) bytes[i] == key[match+i]) {
+                i++;
+            }
+            if (i == length && !key[match+i]) {
+                if (index) {
+                    *index = low * tab->block_size + entry;
+                }
+                return 1;
+            }
+            if (i < length && key[match+i] < (char) bytes[i]) {
+                return 0;
+            }
+            match += i;
+        }
+        bytes += length;
+    }
+
+    return 0;
+}
+
+
+/* Copies the character array at position index of the table tab to the
+character array dest. Size of dest must be larger than
+ms_strtab_max_length(tab) or else the behavior is undefined.
+
+Checks: whether tab and dest are NULL at runtime.
+
+Parameters:
+tab: table returned by ms_strtab_open.
+index: position of the character array in the table.
+dest: destination character array to copy to.
+
+Returns: pointer to destination array dest, or NULL if index is not less
+than ms_strtab_count(tab) */
+char *ms_strtab_get(ms_strtab const *tab, size_t index, char dest[]) {
+    unsigned char const *bytes;
+    size_t i, prefix, length, entry;
+
+    assert(tab);
+    assert(dest);
+
+    if (index >= tab->count) {
+        return NULL;
+    }
+
+    /* decode the arrays of the block up to index */
+    bytes = &tab->blocks[ms_strtab_number(
+        &tab->index[4 * (index / tab->block_size)])];
+    for (entry = 0U; entry <= index % tab->block_size; entry++) {
+        bytes = ms_strtab_varint(bytes, &prefix);
+        bytes = ms_strtab_varint(bytes, &length);
+        for (i = 0U; i < length; i++) {
+            dest[prefix + i] = (char) bytes[i];
+        }
+        dest[prefix + length] = '\0';
+        bytes += length;
+    }
+
+    return dest;
+}
+
+
+/* Deallocates the table tab. The data passed to ms_strtab_open are not
+deallocated.
+
+Checks: whether tab is NULL at runtime.
+
+Parameters:
+tab: table returned by ms_strtab_open. */
+void ms_strtab_close(ms_strtab *tab) {
+    assert(tab);
+
+    free(tab);
+}
+
+
+/* Counts the occurences of the character c (converted to char) in the
+character array str. The terminating null character is not counted.
+
+Checks: whether array is NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+c: character to count.
+
+Returns: number of occurences of c */
+size_t ms_count_char(char const str[], int c) {
+    size_t i, count;
+    char ch;
+
+    assert(str);
+
+    /* add the result of each compare instead of branching on it */
+    ch = (char) c;
+    count = 0U;
+    for (i = 0U; str[i]; i++) {
+        count += str[i] == ch;
+    }
+
+    return count;
+}
+
+
+/* Builds the index of the lines of the character array str, that is the
+offsets of the beginnings of its lines from the beginning of str. A line
+begins at the beginning of str and after each newline character, so the
+number of lines is the number of newline characters plus 1. The returned
+array has exactly that size and must be deallocated with free.
+
+Checks: whether str and num_lines are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+num_lines: receives the number of lines.
+
+Returns: pointer to the array of offsets, or NULL if memory allocation
+fails */
+size_t *ms_line_index(char const str[], size_t *num_lines) {
+    size_t i, line, *lines;
+
+    assert(str);
+    assert(num_lines);
+
+    /* count the lines first so that the index has the exact size */
+    *num_lines = ms_count_char(str, '\n') + 1;
+    lines = malloc(*num_lines * sizeof *lines);
+    if (!lines) {
+        return NULL;
+    }
+
+    /* a line begins after each newline character */
+    lines[0] = 0U;
+    line = 1U;
+    for (i = 0U; str[i]; i++) {
+        if (str[i] == '\n') {
+            lines[line++] = i + 1;
+        }
+    }
+
+    return lines;
+}
+
+
+/* Finds the line of the character array str that contains the character
+at pos, with a binary search of the index of its lines.
+
+Checks: whether lines, str and pos are NULL at runtime.
+
+Parameters:
+lines: index of the lines of str returned by ms_line_index.
+num_lines: number of lines of str.
+str: character array. Must end with null char.
+pos: pointer to a character of str.
+
+Returns: number of the line, starting from 1 */
+size_t ms_line_number(size_t const lines[], size_t num_lines,
+                      char const str[], char const *pos) {
+    size_t low, high, middle, offset;
+
+    assert(lines);
+    assert(str);
+    assert(pos);
+
+    /* find the last line that begins at or before pos */
+    offset = pos - str;
+    low = 0U;
+    high = num_lines;
+    while (high - low > 1) {
+        middle = low + (high - low) / 2;
+        if (lines[middle] <= offset) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low + 1;
 }
\ No newline at end of file
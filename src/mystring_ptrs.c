@@ -3,6 +3,8 @@
 Pointer based implementation */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
 #include "mystring.h"
 #include <assert.h>
 
@@ -104,6 +106,53 @@ char *ms_ncopy(char *dest, char const *src, size_t num) {
 }
 
 
+/* Copies at most size - 1 characters from the character array src to the
+character array dest and ends dest with a null character, unless size is 0.
+The returned pointer can be used as dest of the next call, with size
+reduced accordingly, in order to append to dest without searching for its
+end.
+
+Checks: whether both arrays are NULL at runtime.
+
+Parameters:
+src: source character array to copy from. Must end with null char if its
+length < size.
+dest: destination character array to copy to.
+size: size of dest.
+
+Returns: pointer to the terminating null character of dest, or dest + size
+if src does not fit in dest or size is 0 */
+char *ms_copy_bounded(char *dest, char const *src, size_t size) {
+    char const *src_ptr;
+    char *dest_ptr, *end_ptr;
+
+    assert(dest);
+    assert(src);
+
+    if (!size) {
+        return dest;
+    }
+
+    /* copy all characters except null and at most size - 1 characters */
+    src_ptr = src;
+    dest_ptr = dest;
+    end_ptr = dest + size - 1;
+    while (*src_ptr && dest_ptr != end_ptr) {
+        *dest_ptr++ = *src_ptr++;
+    }
+
+    /* append terminating null character */
+    *dest_ptr = '\0';
+
+    /* src does not fit in dest if it has more characters */
+    if (*src_ptr) {
+        return dest + size;
+    }
+
+    return dest_ptr;
+}
+
+
 /* Appends the character array src to the character array dest.
 It overwrites the terminating null character of src and adds a terminating
 null character at the end of dest. Size of dest must be large enough to hold
@@ -287,4 +336,1956 @@ char *ms_search(char const *haystack, char const *needle) {
     }
 
     return NULL;
+}
+
+
+/* Returns a pointer to the first occurence of needle (of length
+needle_length > 0) in the character array that begins at haystack_ptr,
+or NULL if there is none. */
+static char const *ms_next_match(char const *haystack_ptr,
+                                 char const *needle, size_t needle_length) {
+    while (*haystack_ptr) {
+
+        /* compare only if the first characters are equal */
+        if (*haystack_ptr == *needle &&
+            !ms_ncompare(haystack_ptr, needle, needle_length)) {
+            return haystack_ptr;
+        }
+        haystack_ptr++;
+    }
+
+    return NULL;
+}
+
+
+/* Finds all non-overlapping occurences of the character array needle in the
+character array haystack, scanning from left to right. The offsets of the
+occurences from the beginning of haystack are stored in offsets, up to
+max_offsets of them. An empty needle has no occurences.
+
+Checks: whether both arrays are NULL at runtime.
+
+Parameters:
+haystack: character array. Must end with null char.
+needle: character array. Must end with null char.
+offsets: array that receives the offsets. Can be NULL if max_offsets is 0.
+max_offsets: maximum number of offsets stored in offsets.
+
+Returns: the number of occurences, which can be larger than max_offsets */
+size_t ms_find_all(char const *haystack, char const *needle,
+                   size_t *offsets, size_t max_offsets) {
+    size_t needle_length, count;
+    char const *match_ptr;
+
+    assert(haystack);
+    assert(needle);
+
+    needle_length = ms_length(needle);
+    if (!needle_length) {
+        return 0U;
+    }
+
+    /* continue each search right after the previous occurence */
+    count = 0U;
+    match_ptr = ms_next_match(haystack, needle, needle_length);
+    while (match_ptr) {
+        if (count < max_offsets) {
+            offsets[count] = match_ptr - haystack;
+        }
+        count++;
+        match_ptr = ms_next_match(match_ptr + needle_length,
+                                  needle, needle_length);
+    }
+
+    return count;
+}
+
+
+/* Finds all non-overlapping occurences of the character array needle in the
+character array haystack, scanning from left to right, and calls callback
+for each one of them with its offset from the beginning of haystack.
+An empty needle has no occurences.
+
+Checks: whether haystack, needle and callback are NULL at runtime.
+
+Parameters:
+haystack: character array. Must end with null char.
+needle: character array. Must end with null char.
+callback: function called for each occurence.
+arg: pointer passed unchanged to callback.
+
+Returns: the number of occurences */
+size_t ms_find_each(char const *haystack, char const *needle,
+                    void (*callback)(size_t offset, void *arg), void *arg) {
+    size_t needle_length, count;
+    char const *match_ptr;
+
+    assert(haystack);
+    assert(needle);
+    assert(callback);
+
+    needle_length = ms_length(needle);
+    if (!needle_length) {
+        return 0U;
+    }
+
+    /* continue each search right after the previous occurence */
+    count = 0U;
+    match_ptr = ms_next_match(haystack, needle, needle_length);
+    while (match_ptr) {
+        callback(match_ptr - haystack, arg);
+        count++;
+        match_ptr = ms_next_match(match_ptr + needle_length,
+                                  needle, needle_length);
+    }
+
+    return count;
+}
+
+
+/* Replaces all non-overlapping occurences of the character array from in the
+character array str with the character array to. The result is written to
+a new array that has exactly the size required. An empty from has no
+occurences. The returned array must be deallocated with free.
+
+Checks: whether str, from and to are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+from: character array to replace. Must end with null char.
+to: replacement character array. Must end with null char.
+
+Returns: pointer to the new array, or NULL if memory allocation fails */
+char *ms_replace_all(char const *str, char const *from, char const *to) {
+    size_t str_length, from_length, to_length, count;
+    char const *str_ptr, *match_ptr, *to_ptr;
+    char *result, *result_ptr;
+
+    assert(str);
+    assert(from);
+    assert(to);
+
+    str_length = ms_length(str);
+    from_length = ms_length(from);
+    to_length = ms_length(to);
+    count = ms_find_all(str, from, NULL, 0U);
+
+    result = malloc(str_length - count * from_length + count * to_length + 1);
+    if (!result) {
+        return NULL;
+    }
+
+    /* copy the characters between the occurences followed by to */
+    str_ptr = str;
+    result_ptr = result;
+    match_ptr = count ? ms_next_match(str, from, from_length) : NULL;
+    while (match_ptr) {
+        while (str_ptr != match_ptr) {
+            *result_ptr++ = *str_ptr++;
+        }
+        for (to_ptr = to; *to_ptr; to_ptr++) {
+            *result_ptr++ = *to_ptr;
+        }
+        str_ptr += from_length;
+        match_ptr = ms_next_match(str_ptr, from, from_length);
+    }
+
+    /* copy the characters after the last occurence */
+    while (*str_ptr) {
+        *result_ptr++ = *str_ptr++;
+    }
+    *result_ptr = '\0';
+
+    return result;
+}
+
+
+/* Returns the length of the first of the num non-empty character arrays
+from[i] that str_ptr begins with and stores its index in pair, or returns
+0 if there is no such array. */
+static size_t ms_match_pair(char const *str_ptr, char const *const *from,
+                            size_t num, size_t *pair) {
+    char const *from_ptr, *ptr;
+    size_t i;
+
+    for (i = 0U; i < num; i++) {
+        from_ptr = from[i];
+        ptr = str_ptr;
+        while (*from_ptr && *from_ptr == *ptr) {
+            from_ptr++;
+            ptr++;
+        }
+
+        /* all characters of a non-empty from[i] are equal */
+        if (!*from_ptr && from_ptr != from[i]) {
+            *pair = i;
+            return from_ptr - from[i];
+        }
+    }
+
+    return 0U;
+}
+
+
+/* Replaces the occurences of each of the num character arrays from[i] in the
+character array str with the character array to[i], in a single scan of str.
+At each position of str the pairs are tried in order and the first one that
+matches is replaced, then the scan continues after the replaced characters.
+Empty from arrays have no occurences. The result is written to a new array
+that has exactly the size required. The returned array must be deallocated
+with free.
+
+Checks: whether str, from and to are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+from: num character arrays to replace. Each must end with null char.
+to: num replacement character arrays. Each must end with null char.
+num: number of pairs.
+
+Returns: pointer to the new array, or NULL if memory allocation fails */
+char *ms_replace_multi(char const *str, char const *const *from,
+                       char const *const *to, size_t num) {
+    size_t result_length, match_length, pair;
+    char const *str_ptr, *to_ptr;
+    char *result, *result_ptr;
+
+    assert(str);
+    assert(from);
+    assert(to);
+
+    /* calculate the length of the result */
+    result_length = 0U;
+    str_ptr = str;
+    while (*str_ptr) {
+        match_length = ms_match_pair(str_ptr, from, num, &pair);
+        if (match_length) {
+            result_length += ms_length(to[pair]);
+            str_ptr += match_length;
+        } else {
+            result_length++;
+            str_ptr++;
+        }
+    }
+
+    result = malloc(result_length + 1);
+    if (!result) {
+        return NULL;
+    }
+
+    /* copy each character of str unless a replacement begins there */
+    str_ptr = str;
+    result_ptr = result;
+    while (*str_ptr) {
+        match_length = ms_match_pair(str_ptr, from, num, &pair);
+        if (match_length) {
+            for (to_ptr = to[pair]; *to_ptr; to_ptr++) {
+                *result_ptr++ = *to_ptr;
+            }
+            str_ptr += match_length;
+        } else {
+            *result_ptr++ = *str_ptr++;
+        }
+    }
+    *result_ptr = '\0';
+
+    return result;
+}
+
+
+/* Kinds of the states of the nondeterministic automaton built from the
+patterns: a state matches a character of a set, or any sequence of
+characters, or it is the final state of a pattern */
+enum ms_glob_kind { MS_GLOB_SET, MS_GLOB_STAR, MS_GLOB_END };
+
+
+/* Set of wildcard patterns compiled to a deterministic finite automaton.
+Characters are mapped to classes of characters that cause the same
+transitions, and the transitions of each state are stored in a row of
+num_classes elements. State 0 is the state that no longer matches. */
+struct ms_glob {
+    unsigned char classes[256];
+    size_t num_classes;
+    size_t num_states;
+    size_t capacity;
+    size_t start;
+    unsigned int *transitions;
+    int *accept;
+};
+
+
+/* Workspace of the subset construction. Each state of the deterministic
+automaton is a set of states of the nondeterministic automaton, stored as
+a bitset of set_bytes bytes in dsets. The hash table buckets contains the
+index of each state plus 1, or 0 for empty buckets. */
+struct ms_glob_builder {
+    unsigned char *kinds;
+    unsigned char *sets;
+    size_t num_nfa_states;
+    size_t set_bytes;
+    unsigned char *dsets;
+    size_t *buckets;
+};
+
+
+/* Parses the token of a pattern that begins at pattern_ptr and stores the
+characters it matches in the 256-bit set. Returns a pointer to the next
+token, or NULL if the token is a set that is not terminated by ']' or a
+'\' at the end of the pattern. */
+static char const *ms_glob_token(char const *pattern_ptr,
+                                 unsigned char *set) {
+    char const *first_ptr;
+    unsigned int c, last;
+    int negate;
+
+    for (c = 0U; c < 32U; c++) {
+        set[c] = 0U;
+    }
+
+    if (*pattern_ptr == '*' || *pattern_ptr == '?') {
+        for (c = 0U; c < 32U; c++) {
+            set[c] = 0xFFU;
+        }
+        return pattern_ptr + 1;
+    }
+
+    if (*pattern_ptr == '[') {
+        pattern_ptr++;
+        negate = *pattern_ptr == '!' || *pattern_ptr == '^';
+        if (negate) {
+            pattern_ptr++;
+        }
+
+        /* a ']' right after the opening bracket is a member of the set */
+        first_ptr = pattern_ptr;
+        while (*pattern_ptr && (*pattern_ptr != ']' ||
+                                pattern_ptr == first_ptr)) {
+            if (*pattern_ptr == '\\' && pattern_ptr[1]) {
+                pattern_ptr++;
+            }
+            c = (unsigned char) *pattern_ptr;
+            last = c;
+            if (pattern_ptr[1] == '-' && pattern_ptr[2] &&
+                pattern_ptr[2] != ']') {
+                pattern_ptr += 2;
+                if (*pattern_ptr == '\\' && pattern_ptr[1]) {
+                    pattern_ptr++;
+                }
+                last = (unsigned char) *pattern_ptr;
+            }
+            pattern_ptr++;
+            for (; c <= last; c++) {
+                set[c >> 3] |= 1U << (c & 7U);
+            }
+        }
+        if (!*pattern_ptr) {
+            return NULL;
+        }
+
+        if (negate) {
+            for (c = 0U; c < 32U; c++) {
+                set[c] = (unsigned char) ~set[c];
+            }
+        }
+        return pattern_ptr + 1;
+    }
+
+    /* a '\' escapes the next character, and it cannot end a pattern */
+    if (*pattern_ptr == '\\') {
+        pattern_ptr++;
+        if (!*pattern_ptr) {
+            return NULL;
+        }
+    }
+    c = (unsigned char) *pattern_ptr;
+    set[c >> 3] |= 1U << (c & 7U);
+
+    return pattern_ptr + 1;
+}
+
+
+/* Parses the num patterns to a nondeterministic automaton that has one
+state for each token of a pattern followed by a final state. Stores the
+number of states in num_states and, if kinds is not NULL, the kind of each
+state in kinds and the 256-bit set of each state in sets.
+Returns 0 on success, or -1 if a pattern is not valid. */
+static int ms_glob_parse(char const *const *patterns, size_t num,
+                         unsigned char *kinds, unsigned char *sets,
+                         size_t *num_states) {
+    unsigned char set[32];
+    char const *pattern_ptr;
+    size_t i, state;
+
+    state = 0U;
+    for (i = 0U; i < num; i++) {
+        pattern_ptr = patterns[i];
+        while (*pattern_ptr) {
+            if (kinds) {
+                kinds[state] = *pattern_ptr == '*' ? MS_GLOB_STAR
+                                                   : MS_GLOB_SET;
+            }
+            pattern_ptr = ms_glob_token(pattern_ptr,
+                                        kinds ? &sets[state * 32] : set);
+            if (!pattern_ptr) {
+                return -1;
+            }
+            state++;
+        }
+        if (kinds) {
+            kinds[state] = MS_GLOB_END;
+        }
+        state++;
+    }
+    *num_states = state;
+
+    return 0;
+}
+
+
+/* Partitions the 256 characters in classes of characters that belong to
+the same sets of the states of the nondeterministic automaton and stores
+the class of each character in glob.
+
+Returns: the number of classes */
+static size_t ms_glob_classes(ms_glob *glob,
+                              struct ms_glob_builder const *builder) {
+    unsigned int ids[512];
+    unsigned char const *set;
+    size_t state, num_classes, next_num_classes, i;
+    unsigned int c;
+
+    for (c = 0U; c < 256U; c++) {
+        glob->classes[c] = 0U;
+    }
+    num_classes = 1U;
+
+    /* split each class to the characters that belong to the set of a state
+       and the characters that do not */
+    for (state = 0U; state < builder->num_nfa_states; state++) {
+        if (builder->kinds[state] != MS_GLOB_SET) {
+            continue;
+        }
+        set = &builder->sets[state * 32];
+        for (i = 0U; i < 2 * num_classes; i++) {
+            ids[i] = 256U;
+        }
+        next_num_classes = 0U;
+        for (c = 0U; c < 256U; c++) {
+            i = 2 * glob->classes[c] + ((set[c >> 3] >> (c & 7U)) & 1U);
+            if (ids[i] == 256U) {
+                ids[i] = next_num_classes++;
+            }
+            glob->classes[c] = (unsigned char) ids[i];
+        }
+        num_classes = next_num_classes;
+    }
+
+    return num_classes;
+}
+
+
+/* Adds state to the bitset dset, followed by the states that can be reached
+from it without matching a character. */
+static void ms_glob_closure(unsigned char *dset,
+                            unsigned char const *kinds, size_t state) {
+    dset[state >> 3] |= 1U << (state & 7U);
+    while (kinds[state] == MS_GLOB_STAR) {
+        state++;
+        dset[state >> 3] |= 1U << (state & 7U);
+    }
+}
+
+
+/* Returns the hash of the bitset dset that has set_bytes bytes */
+static size_t ms_glob_hash(unsigned char const *dset, size_t set_bytes) {
+    unsigned char const *end_ptr;
+    size_t hash;
+
+    hash = 2166136261U;
+    for (end_ptr = dset + set_bytes; dset != end_ptr; dset++) {
+        hash = (hash ^ *dset) * 16777619U;
+    }
+
+    return hash;
+}
+
+
+/* Doubles the capacity of the arrays of the deterministic automaton and
+rebuilds the hash table. Returns 0 on success, or -1 if memory allocation
+fails. */
+static int ms_glob_grow(ms_glob *glob, struct ms_glob_builder *builder) {
+    unsigned char *dsets, *dset;
+    unsigned int *transitions;
+    size_t *buckets, capacity, state, i;
+    int *accept;
+
+    capacity = glob->capacity ? 2 * glob->capacity : 16U;
+
+    dsets = realloc(builder->dsets, capacity * builder->set_bytes);
+    if (!dsets) {
+        return -1;
+    }
+    builder->dsets = dsets;
+
+    transitions = realloc(glob->transitions,
+                          capacity * glob->num_classes * sizeof *transitions);
+    if (!transitions) {
+        return -1;
+    }
+    glob->transitions = transitions;
+
+    accept = realloc(glob->accept, capacity * sizeof *accept);
+    if (!accept) {
+        return -1;
+    }
+    glob->accept = accept;
+
+    buckets = realloc(builder->buckets, 2 * capacity * sizeof *buckets);
+    if (!buckets) {
+        return -1;
+    }
+    builder->buckets = buckets;
+    glob->capacity = capacity;
+
+    /* insert the existing states in the hash table */
+    for (i = 0U; i < 2 * capacity; i++) {
+        buckets[i] = 0U;
+    }
+    dset = dsets;
+    for (state = 0U; state < glob->num_states; state++) {
+        i = ms_glob_hash(dset, builder->set_bytes) & (2 * capacity - 1);
+        while (buckets[i]) {
+            i = (i + 1) & (2 * capacity - 1);
+        }
+        buckets[i] = state + 1;
+        dset += builder->set_bytes;
+    }
+
+    return 0;
+}
+
+
+/* Finds the state of the deterministic automaton that corresponds to the
+bitset dset, or adds it if it does not exist, and stores it in state.
+Returns 0 on success, or -1 if the automaton would have more than
+MS_GLOB_MAX_STATES states or memory allocation fails. */
+static int ms_glob_state(ms_glob *glob, struct ms_glob_builder *builder,
+                         unsigned char const *dset, size_t *state) {
+    unsigned char const *dset_ptr, *end_ptr;
+    unsigned char *new_ptr;
+    size_t i, mask, nfa_state;
+    int pattern;
+
+    if (glob->num_states == glob->capacity &&
+        ms_glob_grow(glob, builder)) {
+        return -1;
+    }
+
+    /* search the hash table */
+    mask = 2 * glob->capacity - 1;
+    i = ms_glob_hash(dset, builder->set_bytes) & mask;
+    while (builder->buckets[i]) {
+        dset_ptr = &builder->dsets[(builder->buckets[i] - 1) *
+                                   builder->set_bytes];
+        end_ptr = dset;
+        while (end_ptr != dset + builder->set_bytes &&
+               *end_ptr == *dset_ptr) {
+            end_ptr++;
+            dset_ptr++;
+        }
+        if (end_ptr == dset + builder->set_bytes) {
+            *state = builder->buckets[i] - 1;
+            return 0;
+        }
+        i = (i + 1) & mask;
+    }
+
+    /* add a new state */
+    if (glob->num_states == MS_GLOB_MAX_STATES) {
+        return -1;
+    }
+    *state = glob->num_states++;
+    builder->buckets[i] = glob->num_states;
+    new_ptr = &builder->dsets[*state * builder->set_bytes];
+    for (dset_ptr = dset; dset_ptr != dset + builder->set_bytes; dset_ptr++) {
+        *new_ptr++ = *dset_ptr;
+    }
+
+    /* the state accepts the first pattern whose final state it contains */
+    glob->accept[*state] = -1;
+    pattern = 0;
+    for (nfa_state = 0U; nfa_state < builder->num_nfa_states; nfa_state++) {
+        if (builder->kinds[nfa_state] != MS_GLOB_END) {
+            continue;
+        }
+        if (dset[nfa_state >> 3] & (1U << (nfa_state & 7U))) {
+            glob->accept[*state] = pattern;
+            break;
+        }
+        pattern++;
+    }
+
+    return 0;
+}
+
+
+/* Builds the states of the deterministic automaton with the subset
+construction, starting from the state that no longer matches and the
+start state. Returns 0 on success, or -1 if the automaton would have more
+than MS_GLOB_MAX_STATES states or memory allocation fails. */
+static int ms_glob_build(ms_glob *glob, struct ms_glob_builder *builder,
+                         unsigned char *dset) {
+    unsigned char representatives[256];
+    unsigned char const *current, *set;
+    size_t state, next, nfa_state, i;
+    unsigned int c;
+
+    for (i = 0U; i < builder->set_bytes; i++) {
+        dset[i] = 0U;
+    }
+    if (ms_glob_state(glob, builder, dset, &state)) {
+        return -1;
+    }
+
+    /* the start state contains the first state of each pattern */
+    if (builder->num_nfa_states) {
+        ms_glob_closure(dset, builder->kinds, 0U);
+        for (nfa_state = 0U; nfa_state + 1 < builder->num_nfa_states;
+             nfa_state++) {
+            if (builder->kinds[nfa_state] == MS_GLOB_END) {
+                ms_glob_closure(dset, builder->kinds, nfa_state + 1);
+            }
+        }
+        if (ms_glob_state(glob, builder, dset, &glob->start)) {
+            return -1;
+        }
+    }
+
+    /* any character of a class causes the same transitions */
+    for (c = 256U; c; c--) {
+        representatives[glob->classes[c - 1]] = (unsigned char) (c - 1);
+    }
+
+    for (state = 0U; state < glob->num_states; state++) {
+        for (i = 0U; i < glob->num_classes; i++) {
+            c = representatives[i];
+            for (next = 0U; next < builder->set_bytes; next++) {
+                dset[next] = 0U;
+            }
+
+            /* dsets can move when a state is added */
+            current = &builder->dsets[state * builder->set_bytes];
+            for (nfa_state = 0U; nfa_state < builder->num_nfa_states;
+                 nfa_state++) {
+                if (!(current[nfa_state >> 3] & (1U << (nfa_state & 7U)))) {
+                    continue;
+                }
+                set = &builder->sets[nfa_state * 32];
+                if (builder->kinds[nfa_state] == MS_GLOB_STAR) {
+                    ms_glob_closure(dset, builder->kinds, nfa_state);
+                } else if (builder->kinds[nfa_state] == MS_GLOB_SET &&
+                           (set[c >> 3] & (1U << (c & 7U)))) {
+                    ms_glob_closure(dset, builder->kinds, nfa_state + 1);
+                }
+            }
+
+            if (ms_glob_state(glob, builder, dset, &next)) {
+                return -1;
+            }
+            glob->transitions[state * glob->num_classes + i] =
+                (unsigned int) next;
+        }
+    }
+
+    return 0;
+}
+
+
+/* Compiles the num wildcard patterns to a deterministic finite automaton
+that can be used by ms_glob_match. In a pattern, '*' matches any sequence
+of characters, '?' matches any character, and [set] matches any character
+in set. A set can contain ranges such as a-z, it is negated when it begins
+with '!' or '^', and a ']' is a member of the set if it is the first
+character of the set. A '\' followed by a character matches that character,
+also inside a set. Every other character matches itself. The result must be
+deallocated with ms_glob_free.
+
+Checks: whether patterns is NULL at runtime.
+
+Parameters:
+patterns: num character arrays. Each must end with null char.
+num: number of patterns.
+
+Returns: pointer to the compiled patterns, or NULL if a pattern has a
+set that is not terminated by ']' or ends with a single '\', the automaton
+needs more than MS_GLOB_MAX_STATES states, or memory allocation fails */
+ms_glob *ms_glob_compile(char const *const *patterns, size_t num) {
+    struct ms_glob_builder builder;
+    unsigned char *dset;
+    ms_glob *glob;
+    int error;
+
+    assert(patterns);
+
+    if (ms_glob_parse(patterns, num, NULL, NULL, &builder.num_nfa_states)) {
+        return NULL;
+    }
+
+    glob = malloc(sizeof *glob);
+    if (!glob) {
+        return NULL;
+    }
+    glob->num_states = 0U;
+    glob->capacity = 0U;
+    glob->start = 0U;
+    glob->transitions = NULL;
+    glob->accept = NULL;
+
+    builder.set_bytes = builder.num_nfa_states / 8 + 1;
+    builder.kinds = malloc(builder.num_nfa_states + 1);
+    builder.sets = malloc(builder.num_nfa_states * 32 + 1);
+    builder.dsets = NULL;
+    builder.buckets = NULL;
+    dset = malloc(builder.set_bytes);
+
+    error = !builder.kinds || !builder.sets || !dset;
+    if (!error) {
+        ms_glob_parse(patterns, num, builder.kinds, builder.sets,
+                      &builder.num_nfa_states);
+        glob->num_classes = ms_glob_classes(glob, &builder);
+        error = ms_glob_build(glob, &builder, dset);
+    }
+
+    free(builder.kinds);
+    free(builder.sets);
+    free(builder.dsets);
+    free(builder.buckets);
+    free(dset);
+
+    if (error) {
+        ms_glob_free(glob);
+        return NULL;
+    }
+
+    return glob;
+}
+
+
+/* Matches the character array str against the compiled patterns glob in
+time proportional to the length of str. The whole str must match.
+
+Checks: whether glob and str are NULL at runtime.
+
+Parameters:
+glob: compiled patterns returned by ms_glob_compile.
+str: character array. Must end with null char.
+
+Returns: the index of the first pattern that matches str, or -1 if no
+pattern matches str */
+int ms_glob_match(ms_glob const *glob, char const *str) {
+    unsigned char const *classes;
+    unsigned int const *transitions;
+    size_t num_classes, state;
+    char const *str_ptr;
+
+    assert(glob);
+    assert(str);
+
+    classes = glob->classes;
+    transitions = glob->transitions;
+    num_classes = glob->num_classes;
+
+    /* stop early if the state no longer matches */
+    state = glob->start;
+    str_ptr = str;
+    while (*str_ptr && state) {
+        state = transitions[state * num_classes +
+                            classes[(unsigned char) *str_ptr]];
+        str_ptr++;
+    }
+
+    return glob->accept[state];
+}
+
+
+/* Deallocates the compiled patterns glob.
+
+Checks: whether glob is NULL at runtime.
+
+Parameters:
+glob: compiled patterns returned by ms_glob_compile. */
+void ms_glob_free(ms_glob *glob) {
+    assert(glob);
+
+    free(glob->transitions);
+    free(glob->accept);
+    free(glob);
+}
+
+
+/* Flags of the characters in a set: members of the set, and characters that
+stop a scan for characters not in the set, which also include the null
+character */
+enum ms_byteset_flag { MS_BYTESET_MEMBER = 1, MS_BYTESET_STOP = 2 };
+
+
+/* Finds the first occurence of the character c (converted to char) in the
+character array str. The terminating null character is considered part of
+str, so it is found if c is 0.
+
+Checks: whether array is NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+c: character to find.
+
+Returns: if c is found a pointer to it, else NULL */
+char *ms_find_char(char const *str, int c) {
+    char const *str_ptr;
+    char ch;
+
+    assert(str);
+
+    ch = (char) c;
+    str_ptr = str;
+    while (*str_ptr != ch) {
+        if (!*str_ptr) {
+            return NULL;
+        }
+        str_ptr++;
+    }
+
+    return (char *) str_ptr;
+}
+
+
+/* Finds the last occurence of the character c (converted to char) in the
+character array str. The terminating null character is considered part of
+str, so it is found if c is 0.
+
+Checks: whether array is NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+c: character to find.
+
+Returns: if c is found a pointer to it, else NULL */
+char *ms_rfind_char(char const *str, int c) {
+    char const *str_ptr, *last_ptr;
+    char ch;
+
+    assert(str);
+
+    /* remember the last occurence, including the null character */
+    ch = (char) c;
+    last_ptr = NULL;
+    str_ptr = str;
+    do {
+        if (*str_ptr == ch) {
+            last_ptr = str_ptr;
+        }
+    } while (*str_ptr++);
+
+    return (char *) last_ptr;
+}
+
+
+/* Builds the set of the characters in the character array set.
+
+Checks: whether byteset and set are NULL at runtime.
+
+Parameters:
+byteset: set to build.
+set: character array. Must end with null char. */
+void ms_byteset_init(ms_byteset *byteset, char const *set) {
+    unsigned char *members, *members_ptr;
+    char const *set_ptr;
+
+    assert(byteset);
+    assert(set);
+
+    members = byteset->members;
+    for (members_ptr = members; members_ptr != members + 256; members_ptr++) {
+        *members_ptr = 0U;
+    }
+
+    members[0] = MS_BYTESET_STOP;
+    for (set_ptr = set; *set_ptr; set_ptr++) {
+        members[(unsigned char) *set_ptr] = MS_BYTESET_MEMBER |
+                                            MS_BYTESET_STOP;
+    }
+}
+
+
+/* Finds the first character of the character array str that is in the
+character array set. The terminating null characters are not compared.
+
+Checks: whether both arrays are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+set: character array. Must end with null char.
+
+Returns: if a character is found a pointer to it, else NULL */
+char *ms_find_any(char const *str, char const *set) {
+    ms_byteset byteset;
+
+    assert(str);
+    assert(set);
+
+    ms_byteset_init(&byteset, set);
+
+    return ms_find_any_byteset(str, &byteset);
+}
+
+
+/* Finds the first character of the character array str that is in the set
+byteset. The terminating null character is not compared.
+
+Checks: whether str and byteset are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+byteset: set built by ms_byteset_init.
+
+Returns: if a character is found a pointer to it, else NULL */
+char *ms_find_any_byteset(char const *str, ms_byteset const *byteset) {
+    unsigned char const *members;
+    char const *str_ptr;
+
+    assert(str);
+    assert(byteset);
+
+    /* stop at a member of the set or at the null character */
+    members = byteset->members;
+    str_ptr = str;
+    while (!(members[(unsigned char) *str_ptr] & MS_BYTESET_STOP)) {
+        str_ptr++;
+    }
+
+    return *str_ptr ? (char *) str_ptr : NULL;
+}
+
+
+/* Calculates the length of the initial part of the character array str
+that consists only of characters in the character array set.
+
+Checks: whether both arrays are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+set: character array. Must end with null char.
+
+Returns: length of the initial part of str */
+size_t ms_span(char const *str, char const *set) {
+    ms_byteset byteset;
+
+    assert(str);
+    assert(set);
+
+    ms_byteset_init(&byteset, set);
+
+    return ms_span_byteset(str, &byteset);
+}
+
+
+/* Calculates the length of the initial part of the character array str
+that consists only of characters in the set byteset.
+
+Checks: whether str and byteset are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+byteset: set built by ms_byteset_init.
+
+Returns: length of the initial part of str */
+size_t ms_span_byteset(char const *str, ms_byteset const *byteset) {
+    unsigned char const *members;
+    char const *str_ptr;
+
+    assert(str);
+    assert(byteset);
+
+    /* the null character is not a member of the set */
+    members = byteset->members;
+    str_ptr = str;
+    while (members[(unsigned char) *str_ptr] & MS_BYTESET_MEMBER) {
+        str_ptr++;
+    }
+
+    return str_ptr - str;
+}
+
+
+/* Calculates the length of the initial part of the character array str
+that consists only of characters not in the character array set.
+
+Checks: whether both arrays are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+set: character array. Must end with null char.
+
+Returns: length of the initial part of str */
+size_t ms_cspan(char const *str, char const *set) {
+    ms_byteset byteset;
+
+    assert(str);
+    assert(set);
+
+    ms_byteset_init(&byteset, set);
+
+    return ms_cspan_byteset(str, &byteset);
+}
+
+
+/* Calculates the length of the initial part of the character array str
+that consists only of characters not in the set byteset.
+
+Checks: whether str and byteset are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+byteset: set built by ms_byteset_init.
+
+Returns: length of the initial part of str */
+size_t ms_cspan_byteset(char const *str, ms_byteset const *byteset) {
+    unsigned char const *members;
+    char const *str_ptr;
+
+    assert(str);
+    assert(byteset);
+
+    /* stop at a member of the set or at the null character */
+    members = byteset->members;
+    str_ptr = str;
+    while (!(members[(unsigned char) *str_ptr] & MS_BYTESET_STOP)) {
+        str_ptr++;
+    }
+
+    return str_ptr - str;
+}
+
+
+/* Number of bits of the words used by the bit-parallel edit distance */
+#define MS_WORD_BITS (sizeof(unsigned long) * CHAR_BIT)
+
+
+/* State of the bit-parallel algorithm of Myers for the edit distance of a
+pattern of length characters. The rows of the dynamic programming matrix
+are split in num_blocks blocks of MS_WORD_BITS rows. For each character c,
+peq[c * num_blocks + b] has the bits of the rows of block b whose pattern
+character is c. pv and mv have the bits of the rows of each block whose
+vertical difference in the current column is +1 and -1 respectively, and
+score is the value of the last row. Patterns that fit in one block use the
+storage in small instead of allocating memory. */
+struct ms_myers {
+    size_t num_blocks;
+    size_t score;
+    unsigned long last_bit;
+    unsigned long *peq;
+    unsigned long *pv;
+    unsigned long *mv;
+    unsigned long small[258];
+};
+
+
+/* Initializes the state for the first column of the matrix of the pattern
+that begins at pattern and has length > 0 characters. The pattern is read
+backwards from its last character if reverse is not 0.
+Returns 0 on success, or -1 if memory allocation fails. */
+static int ms_myers_init(struct ms_myers *myers, char const *pattern,
+                         size_t length, int reverse) {
+    unsigned long *word_ptr, *end_ptr;
+    char const *pattern_ptr;
+    size_t num_blocks, row;
+
+    num_blocks = (length + MS_WORD_BITS - 1) / MS_WORD_BITS;
+    if (num_blocks == 1) {
+        myers->peq = myers->small;
+    } else {
+        myers->peq = malloc(258 * num_blocks * sizeof *myers->peq);
+        if (!myers->peq) {
+            return -1;
+        }
+    }
+    myers->num_blocks = num_blocks;
+    myers->pv = myers->peq + 256 * num_blocks;
+    myers->mv = myers->pv + num_blocks;
+    myers->last_bit = 1UL << (length - 1) % MS_WORD_BITS;
+
+    /* the first column has value i in row i */
+    myers->score = length;
+    end_ptr = myers->mv + num_blocks;
+    for (word_ptr = myers->peq; word_ptr != myers->pv; word_ptr++) {
+        *word_ptr = 0UL;
+    }
+    for (word_ptr = myers->pv; word_ptr != myers->mv; word_ptr++) {
+        *word_ptr = ~0UL;
+    }
+    for (word_ptr = myers->mv; word_ptr != end_ptr; word_ptr++) {
+        *word_ptr = 0UL;
+    }
+
+    pattern_ptr = reverse ? pattern + length - 1 : pattern;
+    for (row = 0U; row < length; row++) {
+        myers->peq[(unsigned char) *pattern_ptr * num_blocks +
+                   row / MS_WORD_BITS] |= 1UL << row % MS_WORD_BITS;
+        pattern_ptr += reverse ? -1 : 1;
+    }
+
+    return 0;
+}
+
+
+/* Deallocates the memory of the state, if any */
+static void ms_myers_free(struct ms_myers *myers) {
+    if (myers->peq != myers->small) {
+        free(myers->peq);
+    }
+}
+
+
+/* Calculates the next column of the matrix for the text character c.
+hin is the horizontal difference of the first row, which is 0 when the
+pattern can begin anywhere in the text, or 1 when it must begin at the
+first character of the text. */
+static void ms_myers_step(struct ms_myers *myers, char c, int hin) {
+    unsigned long eq, pv, mv, xv, xh, ph, mh, bit;
+    unsigned long const *peq;
+    size_t block;
+    int hout;
+
+    peq = &myers->peq[(unsigned char) c * myers->num_blocks];
+    for (block = 0U; block < myers->num_blocks; block++) {
+        eq = peq[block];
+        pv = myers->pv[block];
+        mv = myers->mv[block];
+
+        xv = eq | mv;
+        if (hin < 0) {
+            eq |= 1UL;
+        }
+        xh = (((eq & pv) + pv) ^ pv) | eq;
+        ph = mv | ~(xh | pv);
+        mh = pv & xh;
+
+        /* the horizontal difference of the last row of the block is
+           passed to the next block, or it updates the score */
+        bit = block + 1 == myers->num_blocks ? myers->last_bit
+                                             : 1UL << (MS_WORD_BITS - 1);
+        hout = (ph & bit) ? 1 : (mh & bit) ? -1 : 0;
+
+        ph <<= 1;
+        mh <<= 1;
+        if (hin < 0) {
+            mh |= 1UL;
+        } else if (hin > 0) {
+            ph |= 1UL;
+        }
+        myers->pv[block] = mh | ~(xv | ph);
+        myers->mv[block] = ph & xv;
+        hin = hout;
+    }
+
+    if (hin > 0) {
+        myers->score++;
+    } else if (hin < 0) {
+        myers->score--;
+    }
+}
+
+
+/* Finds the first approximate occurence of the character array needle in
+the character array haystack, that is a part of haystack whose edit
+distance from needle is at most k. The edit distance is the minimum number
+of characters that must be inserted, deleted or substituted. The occurence
+that ends first is extended while its distance decreases, and among the
+parts of haystack that end there the one with the lowest distance is
+returned. Runs in time proportional to the length of haystack times the
+number of machine words needed for the bits of needle.
+
+Checks: whether haystack and needle are NULL at runtime.
+
+Parameters:
+haystack: character array. Must end with null char.
+needle: character array. Must end with null char.
+k: maximum edit distance.
+match_length: receives the length of the occurence. Can be NULL.
+
+Returns: if an occurence is found a pointer to it, else NULL. Also returns
+NULL if memory allocation fails */
+char *ms_fuzzy_search(char const *haystack, char const *needle, size_t k,
+                      size_t *match_length) {
+    struct ms_myers myers;
+    char const *end_ptr, *start_ptr, *haystack_ptr;
+    size_t needle_length, score;
+
+    assert(haystack);
+    assert(needle);
+
+    needle_length = ms_length(needle);
+    if (needle_length <= k) {
+        if (match_length) {
+            *match_length = 0U;
+        }
+        return (char *) haystack;
+    }
+
+    if (ms_myers_init(&myers, needle, needle_length, 0)) {
+        return NULL;
+    }
+
+    /* find where the first occurence ends, the needle can begin anywhere */
+    end_ptr = haystack;
+    while (*end_ptr && myers.score > k) {
+        ms_myers_step(&myers, *end_ptr++, 0);
+    }
+    if (myers.score > k) {
+        ms_myers_free(&myers);
+        return NULL;
+    }
+
+    /* extend the occurence while its distance decreases */
+    score = myers.score;
+    while (*end_ptr) {
+        ms_myers_step(&myers, *end_ptr, 0);
+        if (myers.score >= score) {
+            break;
+        }
+        score = myers.score;
+        end_ptr++;
+    }
+    ms_myers_free(&myers);
+
+    /* find the beginning with the reversed needle that must begin at
+       end_ptr, the occurence has at most needle_length + k characters */
+    if (ms_myers_init(&myers, needle, needle_length, 1)) {
+        return NULL;
+    }
+    start_ptr = end_ptr;
+    score = myers.score;
+    haystack_ptr = end_ptr;
+    while (haystack_ptr != haystack &&
+           (size_t) (end_ptr - haystack_ptr) < needle_length + k) {
+        ms_myers_step(&myers, *--haystack_ptr, 1);
+        if (myers.score < score) {
+            score = myers.score;
+            start_ptr = haystack_ptr;
+        }
+    }
+    ms_myers_free(&myers);
+
+    if (match_length) {
+        *match_length = end_ptr - start_ptr;
+    }
+
+    return (char *) start_ptr;
+}
+
+
+/* Calculates the edit distance of the character arrays str1 and str2, that
+is the minimum number of characters that must be inserted, deleted or
+substituted in order to change str1 to str2. Stops early once the distance
+is known to be larger than max_distance.
+
+Checks: whether both arrays are NULL at runtime.
+
+Parameters:
+str1: character array. Must end with null char.
+str2: character array. Must end with null char.
+max_distance: maximum edit distance of interest. Values larger than
+(size_t) -3 are treated as (size_t) -3, so that the results below differ.
+
+Returns: the edit distance if it is at most max_distance, else
+max_distance + 1. Returns (size_t) -1 if memory allocation fails */
+size_t ms_edit_distance(char const *str1, char const *str2,
+                        size_t max_distance) {
+    struct ms_myers myers;
+    size_t length1, length2, remaining;
+    char const *pattern, *text_ptr;
+
+    assert(str1);
+    assert(str2);
+
+    /* max_distance + 1 must not wrap to 0 or equal (size_t) -1 */
+    if (max_distance > (size_t) -3) {
+        max_distance = (size_t) -3;
+    }
+
+    /* the distance is at least the difference of the lengths */
+    length1 = ms_length(str1);
+    length2 = ms_length(str2);
+    if ((length1 > length2 ? length1 - length2 : length2 - length1) >
+        max_distance) {
+        return max_distance + 1;
+    }
+
+    /* the shorter array is the pattern */
+    pattern = str1;
+    text_ptr = str2;
+    if (length1 > length2) {
+        pattern = str2;
+        text_ptr = str1;
+        remaining = length1;
+        length1 = length2;
+    } else {
+        remaining = length2;
+    }
+    if (!length1) {
+        return remaining;
+    }
+
+    if (ms_myers_init(&myers, pattern, length1, 0)) {
+        return (size_t) -1;
+    }
+
+    /* the pattern must begin at the first character of the text. Each
+       remaining character of the text decreases the score by at most 1 */
+    while (*text_ptr) {
+        ms_myers_step(&myers, *text_ptr++, 1);
+        remaining--;
+        if (myers.score > remaining &&
+            myers.score - remaining > max_distance) {
+            ms_myers_free(&myers);
+            return max_distance + 1;
+        }
+    }
+    ms_myers_free(&myers);
+
+    return myers.score;
+}
+
+
+/* Layout of a table of sorted character arrays. All numbers of the header
+and the index are stored in 4 bytes, least significant byte first, and the
+numbers of the blocks in 7-bit groups, least significant group first, with
+the high bit set in all groups but the last.
+
+header: "MSTB", block size, count of arrays, count of blocks, length of the
+longest array, size of the blocks in bytes
+index: offset of each block from the beginning of the blocks
+blocks: for each array, the number of characters it shares with the
+previous array of the block, the number of the rest of its characters and
+the rest of its characters, followed by a null byte that stops compares at
+the end of the table */
+#define MS_STRTAB_HEADER_SIZE 24
+#define MS_STRTAB_MAX_SIZE 0xFFFFFFFFUL
+
+
+/* Builder of a table of sorted character arrays. blocks and offsets grow as
+arrays are added, and last has a copy of the last array added. */
+struct ms_strtab_builder {
+    size_t block_size;
+    size_t count;
+    size_t max_length;
+    unsigned char *blocks;
+    size_t blocks_size;
+    size_t blocks_capacity;
+    unsigned long *offsets;
+    size_t num_blocks;
+    size_t offsets_capacity;
+    char *last;
+    size_t last_capacity;
+};
+
+
+/* Table of sorted character arrays, see the layout above */
+struct ms_strtab {
+    unsigned char const *index;
+    unsigned char const *blocks;
+    size_t block_size;
+    size_t count;
+    size_t num_blocks;
+    size_t max_length;
+};
+
+
+/* Returns the number stored in the 4 bytes at bytes */
+static unsigned long ms_strtab_number(unsigned char const *bytes) {
+    return (unsigned long) bytes[0] | (unsigned long) bytes[1] << 8 |
+           (unsigned long) bytes[2] << 16 | (unsigned long) bytes[3] << 24;
+}
+
+
+/* Stores number in the 4 bytes at bytes */
+static void ms_strtab_put_number(unsigned char *bytes, unsigned long number) {
+    bytes[0] = (unsigned char) (number & 0xFFU);
+    bytes[1] = (unsigned char) (number >> 8 & 0xFFU);
+    bytes[2] = (unsigned char) (number >> 16 & 0xFFU);
+    bytes[3] = (unsigned char) (number >> 24 & 0xFFU);
+}
+
+
+/* Reads the number stored in 7-bit groups at bytes_ptr into number and
+returns a pointer to the next byte */
+static unsigned char const *ms_strtab_varint(unsigned char const *bytes_ptr,
+                                             size_t *number) {
+    unsigned int shift;
+
+    *number = 0U;
+    shift = 0U;
+    while (*bytes_ptr & 0x80U) {
+        *number |= (size_t) (*bytes_ptr++ & 0x7FU) << shift;
+        shift += 7U;
+    }
+    *number |= (size_t) *bytes_ptr++ << shift;
+
+    return bytes_ptr;
+}
+
+
+/* Makes sure that the blocks of the builder can receive num more bytes.
+Returns 0 on success, or -1 if the table would exceed its maximum size or
+memory allocation fails. */
+static int ms_strtab_reserve(ms_strtab_builder *builder, size_t num) {
+    unsigned char *blocks;
+    size_t capacity;
+
+    if (num > MS_STRTAB_MAX_SIZE - builder->blocks_size) {
+        return -1;
+    }
+    if (builder->blocks_size + num <= builder->blocks_capacity) {
+        return 0;
+    }
+
+    capacity = 2 * builder->blocks_capacity + num;
+    blocks = realloc(builder->blocks, capacity);
+    if (!blocks) {
+        return -1;
+    }
+    builder->blocks = blocks;
+    builder->blocks_capacity = capacity;
+
+    return 0;
+}
+
+
+/* Appends number to the blocks of the builder in 7-bit groups. There must
+be enough space for it. */
+static void ms_strtab_put_varint(ms_strtab_builder *builder, size_t number) {
+    unsigned char *bytes_ptr;
+
+    bytes_ptr = &builder->blocks[builder->blocks_size];
+    while (number >= 0x80U) {
+        *bytes_ptr++ = (unsigned char) (number & 0x7FU) | 0x80U;
+        number >>= 7;
+    }
+    *bytes_ptr++ = (unsigned char) number;
+    builder->blocks_size = bytes_ptr - builder->blocks;
+}
+
+
+/* Creates a builder of a table with block_size character arrays in each
+block. Larger blocks need less memory for the index, but lookups decode
+more arrays. The result must be deallocated with ms_strtab_builder_free.
+
+Checks: whether block_size is 0 at runtime.
+
+Parameters:
+block_size: number of character arrays in each block.
+
+Returns: pointer to the builder, or NULL if memory allocation fails */
+ms_strtab_builder *ms_strtab_builder_new(size_t block_size) {
+    ms_strtab_builder *builder;
+
+    assert(block_size);
+
+    builder = malloc(sizeof *builder);
+    if (!builder) {
+        return NULL;
+    }
+    builder->block_size = block_size;
+    builder->count = 0U;
+    builder->max_length = 0U;
+    builder->blocks = NULL;
+    builder->blocks_size = 0U;
+    builder->blocks_capacity = 0U;
+    builder->offsets = NULL;
+    builder->num_blocks = 0U;
+    builder->offsets_capacity = 0U;
+    builder->last = NULL;
+    builder->last_capacity = 0U;
+
+    return builder;
+}
+
+
+/* Adds the character array str to the table. Arrays must be added in
+strictly ascending order according to ms_compare.
+
+Checks: whether builder and str are NULL at runtime.
+
+Parameters:
+builder: builder returned by ms_strtab_builder_new.
+str: character array. Must end with null char.
+
+Returns: 0 on success, or -1 if str is not greater than the previous
+array, the table exceeds 4 GiB, or memory allocation fails */
+int ms_strtab_builder_add(ms_strtab_builder *builder, char const *str) {
+    unsigned long *offsets;
+    char const *str_ptr, *last_ptr;
+    size_t length, prefix, capacity;
+    char *last;
+
+    assert(builder);
+    assert(str);
+
+    if (builder->count && ms_compare(builder->last, str) >= 0) {
+        return -1;
+    }
+    length = ms_length(str);
+
+    /* the first array of a block begins a new block and shares nothing */
+    prefix = 0U;
+    if (builder->count % builder->block_size == 0) {
+        if (builder->num_blocks == builder->offsets_capacity) {
+            capacity = 2 * builder->offsets_capacity + 16;
+            offsets = realloc(builder->offsets, capacity * sizeof *offsets);
+            if (!offsets) {
+                return -1;
+            }
+            builder->offsets = offsets;
+            builder->offsets_capacity = capacity;
+        }
+    } else {
+        str_ptr = str;
+        last_ptr = builder->last;
+        while (*str_ptr && *str_ptr == *last_ptr) {
+            str_ptr++;
+            last_ptr++;
+        }
+        prefix = str_ptr - str;
+    }
+
+    /* keep a copy of str to compare it with the next array */
+    if (length >= builder->last_capacity) {
+        capacity = 2 * length + 1;
+        last = realloc(builder->last, capacity);
+        if (!last) {
+            return -1;
+        }
+        builder->last = last;
+        builder->last_capacity = capacity;
+    }
+
+    /* 2 numbers of at most 10 bytes, the characters and a null byte */
+    if (ms_strtab_reserve(builder, 2 * 10 + length - prefix + 1)) {
+        return -1;
+    }
+    if (builder->count % builder->block_size == 0) {
+        builder->offsets[builder->num_blocks++] = builder->blocks_size;
+    }
+    ms_strtab_put_varint(builder, prefix);
+    ms_strtab_put_varint(builder, length - prefix);
+    for (str_ptr = str + prefix; *str_ptr; str_ptr++) {
+        builder->blocks[builder->blocks_size++] = (unsigned char) *str_ptr;
+    }
+
+    ms_copy(builder->last, str);
+    if (length > builder->max_length) {
+        builder->max_length = length;
+    }
+    builder->count++;
+
+    return 0;
+}
+
+
+/* Writes the table to file.
+
+Checks: whether builder and file are NULL at runtime.
+
+Parameters:
+builder: builder returned by ms_strtab_builder_new.
+file: file opened for writing in binary mode.
+
+Returns: 0 on success, or -1 if writing fails */
+int ms_strtab_builder_write(ms_strtab_builder const *builder, FILE *file) {
+    unsigned char header[MS_STRTAB_HEADER_SIZE], number[4];
+    unsigned long const *offset_ptr;
+
+    assert(builder);
+    assert(file);
+
+    header[0] = 'M';
+    header[1] = 'S';
+    header[2] = 'T';
+    header[3] = 'B';
+    ms_strtab_put_number(&header[4], builder->block_size);
+    ms_strtab_put_number(&header[8], builder->count);
+    ms_strtab_put_number(&header[12], builder->num_blocks);
+    ms_strtab_put_number(&header[16], builder->max_length);
+    ms_strtab_put_number(&header[20], builder->blocks_size + 1);
+    if (fwrite(header, 1, sizeof header, file) != sizeof header) {
+        return -1;
+    }
+
+    for (offset_ptr = builder->offsets;
+         offset_ptr != builder->offsets + builder->num_blocks; offset_ptr++) {
+        ms_strtab_put_number(number, *offset_ptr);
+        if (fwrite(number, 1, sizeof number, file) != sizeof number) {
+            return -1;
+        }
+    }
+
+    /* the blocks are followed by a null byte */
+    if ((builder->blocks_size &&
+         fwrite(builder->blocks, 1, builder->blocks_size, file) !=
+         builder->blocks_size) || fputc('\0', file) == EOF) {
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/* Deallocates the builder.
+
+Checks: whether builder is NULL at runtime.
+
+Parameters:
+builder: builder returned by ms_strtab_builder_new. */
+void ms_strtab_builder_free(ms_strtab_builder *builder) {
+    assert(builder);
+
+    free(builder->blocks);
+    free(builder->offsets);
+    free(builder->last);
+    free(builder);
+}
+
+
+/* Opens the table that has been written by ms_strtab_builder_write and
+occupies the size bytes at data. Only the header of the table is checked,
+and data is used in place, so it must remain valid and unchanged until
+ms_strtab_close. It can be a read-only memory mapping of the file.
+The result must be deallocated with ms_strtab_close.
+
+Checks: whether data is NULL at runtime.
+
+Parameters:
+data: contents of the table.
+size: number of bytes of data.
+
+Returns: pointer to the table, or NULL if data is not a table or memory
+allocation fails */
+ms_strtab *ms_strtab_open(void const *data, size_t size) {
+    unsigned char const *bytes;
+    size_t block_size, count, num_blocks, blocks_size;
+    ms_strtab *tab;
+
+    assert(data);
+
+    bytes = data;
+    if (size < MS_STRTAB_HEADER_SIZE || bytes[0] != 'M' || bytes[1] != 'S' ||
+        bytes[2] != 'T' || bytes[3] != 'B' || bytes[size - 1]) {
+        return NULL;
+    }
+    block_size = ms_strtab_number(&bytes[4]);
+    count = ms_strtab_number(&bytes[8]);
+    num_blocks = ms_strtab_number(&bytes[12]);
+    blocks_size = ms_strtab_number(&bytes[20]);
+
+    /* the sizes must agree with the counts */
+    if (!block_size || num_blocks != (count + block_size - 1) / block_size ||
+        !blocks_size || (size - MS_STRTAB_HEADER_SIZE) / 4 < num_blocks ||
+        size - MS_STRTAB_HEADER_SIZE - 4 * num_blocks != blocks_size) {
+        return NULL;
+    }
+
+    tab = malloc(sizeof *tab);
+    if (!tab) {
+        return NULL;
+    }
+    tab->index = &bytes[MS_STRTAB_HEADER_SIZE];
+    tab->blocks = tab->index + 4 * num_blocks;
+    tab->block_size = block_size;
+    tab->count = count;
+    tab->num_blocks = num_blocks;
+    tab->max_length = ms_strtab_number(&bytes[16]);
+
+    return tab;
+}
+
+
+/* Returns the number of character arrays in the table tab.
+
+Checks: whether tab is NULL at runtime.
+
+Parameters:
+tab: table returned by ms_strtab_open.
+
+Returns: number of character arrays */
+size_t ms_strtab_count(ms_strtab const *tab) {
+    assert(tab);
+
+    return tab->count;
+}
+
+
+/* Returns the length of the longest character array in the table tab.
+
+Checks: whether tab is NULL at runtime.
+
+Parameters:
+tab: table returned by ms_strtab_open.
+
+Returns: length of the longest character array */
+size_t ms_strtab_max_length(ms_strtab const *tab) {
+    assert(tab);
+
+    return tab->max_length;
+}
+
+
+/* Finds the character array key in the table tab with a binary search of
+the blocks followed by a scan of one block.
+
+Checks: whether tab and key are NULL at runtime.
+
+Parameters:
+tab: table returned by ms_strtab_open.
+key: character array. Must end with null char.
+index: receives the position of key in the table. Can be NULL.
+
+Returns: 1 if key is found, else 0 */
+int ms_strtab_find(ms_strtab const *tab, char const *key, size_t *index) {
+    unsigned char const *bytes_ptr, *end_ptr;
+    size_t low, high, middle, length, prefix, match, entry, entries;
+    char const *chars, *key_ptr;
+    int result;
+
+    assert(tab);
+    assert(key);
+
+    if (!tab->count) {
+        return 0;
+    }
+
+    /* find the last block whose first array is not greater than key. The
+       first array of a block shares no characters, so it begins with a
+       single 0 byte */
+    low = 0U;
+    high = tab->num_blocks;
+    while (high - low > 1) {
+        middle = low + (high - low) / 2;
+        bytes_ptr = &tab->blocks[ms_strtab_number(&tab->index[4 * middle])];
+        bytes_ptr = ms_strtab_varint(bytes_ptr + 1, &length);
+        result = ms_ncompare(key, (char const *) bytes_ptr, length);
+
+        /* if the first length characters are equal, compare the next
+           character of key with the end of the array */
+        if (result < 0 || (!result && key[length] < '\0')) {
+            high = middle;
+        } else {
+            low = middle;
+        }
+    }
+
+    /* scan the block, match is the number of characters that the
+       current array shares with key */
+    bytes_ptr = &tab->blocks[ms_strtab_number(&tab->index[4 * low])];
+    entries = tab->count - low * tab->block_size;
+    if (entries > tab->block_size) {
+        entries = tab->block_size;
+    }
+    match = 0U;
+    for (entry = 0U; entry < entries; entry++) {
+        bytes_ptr = ms_strtab_varint(bytes_ptr, &prefix);
+        bytes_ptr = ms_strtab_varint(bytes_ptr, &length);
+        end_ptr = bytes_ptr + length;
+
+        /* an array that shares more characters with the previous array
+           than key is still less than key, one that shares fewer is
+           greater than key */
+        if (prefix < match) {
+            return 0;
+        }
+        if (prefix == match) {
+            chars = (char const *) bytes_ptr;
+            key_ptr = key + match;
+            while (chars != (char const *) end_ptr && *chars == *key_ptr) {
+                chars++;
+                key_ptr++;
+            }
+            if (chars == (char const *) end_ptr && !*key_ptr) {
+                if (index) {
+                    *index = low * tab->block_size + entry;
+                }
+                return 1;
+            }
+            if (chars != (char const *) end_ptr && *key_ptr < *chars) {
+                return 0;
+            }
+            match = key_ptr - key;
+        }
+        bytes_ptr = end_ptr;
+    }
+
+    return 0;
+}
+
+
+/* Copies the character array at position index of the table tab to the
+character array dest. Size of dest must be larger than
+ms_strtab_max_length(tab) or else the behavior is undefined.
+
+Checks: whether tab and dest are NULL at runtime.
+
+Parameters:
+tab: table returned by ms_strtab_open.
+index: position of the character array in the table.
+dest: destination character array to copy to.
+
+Returns: pointer to destination array dest, or NULL if index is not less
+than ms_strtab_count(tab) */
+char *ms_strtab_get(ms_strtab const *tab, size_t index, char *dest) {
+    unsigned char const *bytes_ptr, *end_ptr;
+    size_t prefix, length, entry;
+    char *dest_ptr;
+
+    assert(tab);
+    assert(dest);
+
+    if (index >= tab->count) {
+        return NULL;
+    }
+
+    /* decode the arrays of the block up to index */
+    bytes_ptr = &tab->blocks[ms_strtab_number(
+        &tab->index[4 * (index / tab->block_size)])];
+    for (entry = 0U; entry <= index % tab->block_size; entry++) {
+        bytes_ptr = ms_strtab_varint(bytes_ptr, &prefix);
+        bytes_ptr = ms_strtab_varint(bytes_ptr, &length);
+        dest_ptr = dest + prefix;
+        for (end_ptr = bytes_ptr + length; bytes_ptr != end_ptr; bytes_ptr++) {
+            *dest_ptr++ = (char) *bytes_ptr;
+        }
+        *dest_ptr = '\0';
+    }
+
+    return dest;
+}
+
+
+/* Deallocates the table tab. The data passed to ms_strtab_open are not
+deallocated.
+
+Checks: whether tab is NULL at runtime.
+
+Parameters:
+tab: table returned by ms_strtab_open. */
+void ms_strtab_close(ms_strtab *tab) {
+    assert(tab);
+
+    free(tab);
+}
+
+
+/* Counts the occurences of the character c (converted to char) in the
+character array str. The terminating null character is not counted.
+
+Checks: whether array is NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+c: character to count.
+
+Returns: number of occurences of c */
+size_t ms_count_char(char const *str, int c) {
+    char const *str_ptr;
+    size_t count;
+    char ch;
+
+    assert(str);
+
+    /* add the result of each compare instead of branching on it */
+    ch = (char) c;
+    count = 0U;
+    for (str_ptr = str; *str_ptr; str_ptr++) {
+        count += *str_ptr == ch;
+    }
+
+    return count;
+}
+
+
+/* Builds the index of the lines of the character array str, that is the
+offsets of the beginnings of its lines from the beginning of str. A line
+begins at the beginning of str and after each newline character, so the
+number of lines is the number of newline characters plus 1. The returned
+array has exactly that size and must be deallocated with free.
+
+Checks: whether str and num_lines are NULL at runtime.
+
+Parameters:
+str: character array. Must end with null char.
+num_lines: receives the number of lines.
+
+Returns: pointer to the array of offsets, or NULL if memory allocation
+fails */
+size_t *ms_line_index(char const *str, size_t *num_lines) {
+    char const *str_ptr;
+    size_t *lines, *line_ptr;
+
+    assert(str);
+    assert(num_lines);
+
+    /* count the lines first so that the index has the exact size */
+    *num_lines = ms_count_char(str, '\n') + 1;
+    lines = malloc(*num_lines * sizeof *lines);
+    if (!lines) {
+        return NULL;
+    }
+
+    /* a line begins after each newline character */
+    line_ptr = lines;
+    *line_ptr++ = 0U;
+    str_ptr = ms_find_char(str, '\n');
+    while (str_ptr) {
+        str_ptr++;
+        *line_ptr++ = str_ptr - str;
+        str_ptr = ms_find_char(str_ptr, '\n');
+    }
+
+    return lines;
+}
+
+
+/* Finds the line of the character array str that contains the character
+at pos, with a binary search of the index of its lines.
+
+Checks: whether lines, str and pos are NULL at runtime.
+
+Parameters:
+lines: index of the lines of str returned by ms_line_index.
+num_lines: number of lines of str.
+str: character array. Must end with null char.
+pos: pointer to a character of str.
+
+Returns: number of the line, starting from 1 */
+size_t ms_line_number(size_t const *lines, size_t num_lines,
+                      char const *str, char const *pos) {
+    size_t const *low_ptr, *high_ptr, *middle_ptr;
+    size_t offset;
+
+    assert(lines);
+    assert(str);
+    assert(pos);
+
+    /* find the last line that begins at or before pos */
+    offset = pos - str;
+    low_ptr = lines;
+    high_ptr = lines + num_lines;
+    while (high_ptr - low_ptr > 1) {
+        middle_ptr = low_ptr + (high_ptr - low_ptr) / 2;
+        if (*middle_ptr <= offset) {
+            low_ptr = middle_ptr;
+        } else {
+            high_ptr = middle_ptr;
+        }
+    }
+
+    return low_ptr - lines + 1;
 }
\ No newline at end of file